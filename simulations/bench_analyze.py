@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+#
+# Summarize the scalability benchmark runs (the Bench_* configs in
+# omnetpp.ini) and compare them with a stored baseline.
+#
+# For every run we print the ring size N, the key space bits m, the number of
+# clients C, the mean hop count and its ratio to log2 N, the steady-state RTT
+# percentiles, the messages per lookup and the simulator's events per second.
+# For the ring size sweep we also fit the mean hop count against log2 N; Chord
+# should come out close to a slope of 1/2.
+#
+# usage: bench_analyze.py [--results DIR] [--baseline FILE] [--save-baseline]
+#                         [--tolerance FRACTION]
+#
+# Exits with status 1 if any run regressed against the baseline by more than
+# the tolerance, so the benchmark can gate a change.
+
+import argparse
+import glob
+import json
+import math
+import os
+import re
+import sys
+
+# metric name -> (scalar it comes from, True if larger is better)
+METRICS = {
+    'hops':       (None, False),
+    'rttP50':     ('rttP50', False),
+    'rttP90':     ('rttP90', False),
+    'rttP99':     ('rttP99', False),
+    'msgsLookup': ('messagesPerLookup', False),
+    'eventsSec':  ('eventsPerSecond', True),
+}
+
+# the simulator speed is measured on the wall clock and is far noisier than
+# the simulated quantities, so it gets a wider margin
+NOISY = { 'eventsSec': 3.0 }
+
+
+def parse_sca (filename):
+    """Return (configname, itervars, scalars, hop (count, mean) pairs) of a .sca file."""
+    config = None
+    itervars = {}
+    scalars = {}
+    hops = []
+    stat = None
+    fields = {}
+
+    def close_stat ():
+        if stat is not None and stat.endswith ('hopCount:stats') and 'count' in fields:
+            hops.append ((fields['count'], fields.get ('mean', 0.0)))
+
+    with open (filename) as f:
+        for line in f:
+            parts = line.split ()
+            if not parts:
+                continue
+            if parts[0] == 'statistic':
+                close_stat ()
+                stat = parts[2]
+                fields = {}
+            elif parts[0] == 'field' and stat is not None:
+                fields[parts[1]] = float (parts[2])
+            elif parts[0] == 'attr' and parts[1] == 'configname':
+                config = parts[2]
+            elif parts[0] == 'attr' and parts[1] == 'iterationvars':
+                for name, value in re.findall (r'\$(\w+)=([^,"\s]+)', line):
+                    itervars[name] = value
+            elif parts[0] == 'itervar':
+                itervars[parts[1]] = parts[2].strip ('"')
+            elif parts[0] == 'scalar' and '.coordinator' in parts[1]:
+                scalars[parts[2]] = float (parts[3])
+    close_stat ()
+    return config, itervars, scalars, hops
+
+
+def summarize (filename):
+    config, itervars, scalars, hops = parse_sca (filename)
+    if config is None or 'lookupsCompleted' not in scalars:
+        return None
+
+    count = sum (c for c, m in hops)
+    # the sweep variables, falling back to what the coordinator recorded for
+    # the values a config does not iterate over
+    row = {
+        'config': config,
+        'N': int (itervars.get ('N', scalars.get ('numChordNodes', 0))),
+        'm': int (itervars.get ('m', scalars.get ('m', 0))),
+        'C': int (itervars.get ('C', scalars.get ('numClients', 0))),
+        'hops': sum (c * m for c, m in hops) / count if count else 0.0,
+    }
+    for metric, (scalar, _) in METRICS.items ():
+        if scalar is not None:
+            row[metric] = scalars.get (scalar, 0.0)
+    row['key'] = '%s N=%d m=%d C=%d' % (config, row['N'], row['m'], row['C'])
+    return row
+
+
+def fit_slope (rows):
+    """Least-squares slope of the mean hop count against log2 N."""
+    pts = [(math.log2 (r['N']), r['hops']) for r in rows if r['N'] > 1]
+    if len (pts) < 2:
+        return None
+    mx = sum (x for x, y in pts) / len (pts)
+    my = sum (y for x, y in pts) / len (pts)
+    sxx = sum ((x - mx) ** 2 for x, y in pts)
+    sxy = sum ((x - mx) * (y - my) for x, y in pts)
+    return sxy / sxx if sxx > 0 else None
+
+
+def main ():
+    ap = argparse.ArgumentParser (description='summarize the chord scalability benchmark')
+    ap.add_argument ('--results', default='results', help='directory holding the .sca files')
+    ap.add_argument ('--baseline', default='bench_baseline.json', help='baseline to compare against')
+    ap.add_argument ('--save-baseline', action='store_true', help='store these results as the new baseline')
+    ap.add_argument ('--tolerance', type=float, default=0.10, help='allowed relative regression')
+    args = ap.parse_args ()
+
+    rows = []
+    for sca in sorted (glob.glob (os.path.join (args.results, 'Bench_*.sca'))):
+        row = summarize (sca)
+        if row is not None:
+            rows.append (row)
+    if not rows:
+        print ('no benchmark results found in %s' % args.results)
+        return 1
+
+    # the ring size (N) values are the natural x axis; keep configs together
+    rows.sort (key=lambda r: (r['config'], r['m'], r['C'], r['N']))
+
+    baseline = {}
+    if os.path.exists (args.baseline) and not args.save_baseline:
+        with open (args.baseline) as f:
+            baseline = json.load (f)
+
+    header = '%-14s %6s %3s %3s %6s %6s %7s %10s %10s %10s %8s %10s' % (
+        'config', 'N', 'm', 'C', 'log2N', 'hops', 'h/logN', 'p50', 'p90', 'p99', 'msg/lk', 'ev/s')
+    print (header)
+    print ('-' * len (header))
+
+    regressions = []
+    for r in rows:
+        logn = math.log2 (r['N']) if r['N'] > 1 else 0.0
+        print ('%-14s %6d %3d %3d %6.2f %6.2f %7.3f %10.6f %10.6f %10.6f %8.2f %10.0f' % (
+            r['config'], r['N'], r['m'], r['C'], logn, r['hops'],
+            r['hops'] / logn if logn > 0 else 0.0,
+            r['rttP50'], r['rttP90'], r['rttP99'], r['msgsLookup'], r['eventsSec']))
+
+        base = baseline.get (r['key'])
+        if base is None:
+            continue
+        for metric, (_, higherIsBetter) in METRICS.items ():
+            old, new = base.get (metric), r[metric]
+            if not old:
+                continue
+            change = (new - old) / old
+            worse = -change if higherIsBetter else change
+            if worse > args.tolerance * NOISY.get (metric, 1.0):
+                regressions.append ('%s: %s %.6g -> %.6g (%+.1f%%)' % (
+                    r['key'], metric, old, new, 100.0 * change))
+
+    slope = fit_slope ([r for r in rows if r['config'] == 'Bench_ScaleN'])
+    if slope is not None:
+        print ('\nBench_ScaleN: mean hops = %.3f * log2 N + c (chord predicts 0.5)' % slope)
+
+    if args.save_baseline:
+        with open (args.baseline, 'w') as f:
+            json.dump (dict ((r['key'], dict ((m, r[m]) for m in METRICS)) for r in rows),
+                       f, indent=1, sort_keys=True)
+        print ('\nbaseline written to %s' % args.baseline)
+        return 0
+
+    if not baseline:
+        print ('\nno baseline to compare with (use --save-baseline to store one)')
+        return 0
+
+    if regressions:
+        print ('\nREGRESSIONS (tolerance %.0f%%):' % (100.0 * args.tolerance))
+        for line in regressions:
+            print ('  ' + line)
+        return 1
+
+    print ('\nno regressions against %s' % args.baseline)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit (main ())
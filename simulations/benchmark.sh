@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# Run the scalability benchmark suite (the Bench_* configs in omnetpp.ini)
+# and summarize it against the stored baseline.
+#
+#   ./benchmark.sh                  run everything and compare
+#   ./benchmark.sh --save-baseline  run everything and make it the baseline
+#   CONFIGS="Bench_ScaleN" ./benchmark.sh   run only some of the configs
+#
+# Runs of a config are spread over all cores with opp_runall if it exists.
+cd `dirname $0`
+
+CONFIGS=${CONFIGS:-"Bench_ScaleN Bench_ScaleM Bench_Clients"}
+JOBS=${JOBS:-`nproc 2>/dev/null || echo 1`}
+
+mkdir -p results
+rm -f results/Bench_*
+
+for c in $CONFIGS; do
+    if command -v opp_runall >/dev/null 2>&1; then
+        opp_runall -j$JOBS ./run -u Cmdenv -c $c || exit 1
+    else
+        ./run -u Cmdenv -c $c || exit 1
+    fi
+done
+
+python3 bench_analyze.py --results results "$@"
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+#
+# Profile the simulator itself at scale. Runs the Prof_* configs of
+# omnetpp.ini in Cmdenv express mode, one process per run, and reports for
+# every run the wall clock time, the number of events, events per second and
+# the peak resident set size of the process.
+#
+# Each Prof_* config runs one population (chord nodes or clients) at two
+# sizes. The RSS difference between the two, divided by the difference in
+# population, is the memory one more ChordNode (host included) or Client
+# costs.
+#
+# usage: profile_harness.py [--configs C ...] [--repeat K] [--baseline FILE]
+#                           [--save-baseline] [--tolerance FRACTION]
+#
+# With --repeat the fastest of K runs is kept, which takes most of the noise
+# of a shared machine out. Exits with status 1 if any run got slower or bigger
+# than the baseline by more than the tolerance.
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+from bench_analyze import parse_sca
+
+# config -> (iteration variable swept, what it counts)
+CONFIGS = {
+    'Prof_Nodes':   ('N', 'ChordNode'),
+    'Prof_Clients': ('C', 'Client'),
+}
+
+# metric -> True if larger is better
+METRICS = {
+    'wallClock':  False,
+    'eventsSec':  True,
+    'peakRssKiB': False,
+}
+
+
+def num_runs (config):
+    """Ask the simulation how many runs a config expands to."""
+    out = subprocess.run (['./run', '-u', 'Cmdenv', '-c', config, '-q', 'numruns'],
+                          stdout=subprocess.PIPE, universal_newlines=True, check=True).stdout
+    # depending on the version the count comes alone or after a label
+    numbers = re.findall (r'\d+', out)
+    if numbers:
+        return int (numbers[-1])
+    raise RuntimeError ('cannot determine the number of runs of %s' % config)
+
+
+def run_once (config, run):
+    """Run one simulation; return (wall clock seconds, peak RSS in KiB)."""
+    start = time.monotonic ()
+    proc = subprocess.Popen (['./run', '-u', 'Cmdenv', '-c', config, '-r', str (run)],
+                             stdout=subprocess.DEVNULL)
+    # wait4 gives us the resource usage of this one child
+    _, status, usage = os.wait4 (proc.pid, 0)
+    wall = time.monotonic () - start
+    if os.WIFEXITED (status) and os.WEXITSTATUS (status) != 0:
+        raise RuntimeError ('%s run %d failed' % (config, run))
+
+    # ru_maxrss is in KiB on Linux but in bytes on macOS
+    rss = usage.ru_maxrss / 1024 if sys.platform == 'darwin' else usage.ru_maxrss
+    return wall, rss
+
+
+def profile (config, repeat):
+    rows = []
+    for run in range (num_runs (config)):
+        best = None
+        for _ in range (repeat):
+            wall, rss = run_once (config, run)
+            if best is None or wall < best[0]:
+                best = (wall, rss)
+
+        # the event count comes from the coordinator's scalars
+        matches = glob.glob ('results/%s-%d.sca' % (config, run))
+        _, itervars, scalars, _ = parse_sca (matches[0]) if matches else (None, {}, {}, [])
+        events = scalars.get ('simEvents', 0.0)
+        var = CONFIGS[config][0]
+        rows.append ({
+            'config': config,
+            'size': int (itervars.get (var, 0)),
+            'key': '%s %s=%s' % (config, var, itervars.get (var, run)),
+            'wallClock': best[0],
+            'events': events,
+            'eventsSec': events / best[0] if best[0] > 0 else 0.0,
+            'peakRssKiB': best[1],
+        })
+    return rows
+
+
+def main ():
+    ap = argparse.ArgumentParser (description='profile the chord simulation model')
+    ap.add_argument ('--configs', nargs='+', default=sorted (CONFIGS), help='Prof_* configs to run')
+    ap.add_argument ('--repeat', type=int, default=1, help='runs per measurement; the fastest is kept')
+    ap.add_argument ('--baseline', default='profile_baseline.json', help='baseline to compare against')
+    ap.add_argument ('--save-baseline', action='store_true', help='store these results as the new baseline')
+    ap.add_argument ('--tolerance', type=float, default=0.15, help='allowed relative regression')
+    args = ap.parse_args ()
+
+    os.chdir (os.path.dirname (os.path.abspath (__file__)))
+    os.makedirs ('results', exist_ok=True)
+
+    rows = []
+    for config in args.configs:
+        if config not in CONFIGS:
+            print ('unknown profiling config %s' % config)
+            return 2
+        rows.extend (profile (config, max (args.repeat, 1)))
+
+    header = '%-14s %-10s %10s %12s %12s %12s' % ('config', 'run', 'wall [s]', 'events', 'ev/s', 'peak RSS')
+    print (header)
+    print ('-' * len (header))
+    for r in rows:
+        print ('%-14s %-10s %10.2f %12.0f %12.0f %9.1f MiB' % (
+            r['config'], r['key'].split (' ', 1)[1], r['wallClock'], r['events'],
+            r['eventsSec'], r['peakRssKiB'] / 1024.0))
+
+    # memory per entity from the smallest and the largest run of a config
+    print ('')
+    for config in args.configs:
+        runs = sorted ((r for r in rows if r['config'] == config), key=lambda r: r['size'])
+        if len (runs) >= 2 and runs[-1]['size'] > runs[0]['size']:
+            perEntity = (runs[-1]['peakRssKiB'] - runs[0]['peakRssKiB']) / (runs[-1]['size'] - runs[0]['size'])
+            print ('memory per %-10s %8.1f KiB' % (CONFIGS[config][1], perEntity))
+
+    if args.save_baseline:
+        with open (args.baseline, 'w') as f:
+            json.dump (dict ((r['key'], dict ((m, r[m]) for m in METRICS)) for r in rows),
+                       f, indent=1, sort_keys=True)
+        print ('\nbaseline written to %s' % args.baseline)
+        return 0
+
+    if not os.path.exists (args.baseline):
+        print ('\nno baseline to compare with (use --save-baseline to store one)')
+        return 0
+
+    with open (args.baseline) as f:
+        baseline = json.load (f)
+
+    regressions = []
+    for r in rows:
+        base = baseline.get (r['key'])
+        if base is None:
+            continue
+        for metric, higherIsBetter in METRICS.items ():
+            old, new = base.get (metric), r[metric]
+            if not old:
+                continue
+            change = (new - old) / old
+            worse = -change if higherIsBetter else change
+            if worse > args.tolerance:
+                regressions.append ('%s: %s %.6g -> %.6g (%+.1f%%)' % (
+                    r['key'], metric, old, new, 100.0 * change))
+
+    if regressions:
+        print ('\nREGRESSIONS (tolerance %.0f%%):' % (100.0 * args.tolerance))
+        for line in regressions:
+            print ('  ' + line)
+        return 1
+
+    print ('\nno regressions against %s' % args.baseline)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit (main ())
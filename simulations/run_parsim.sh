@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+# Run a parallel config on this machine: one process per partition, all
+# started together, with the output of partition p in results/<config>-p<p>.log.
+#
+#   ./run_parsim.sh <partitions> <config> [more opp_run options]
+#
+# The config must set parallel-simulation and the partition-id of every
+# top-level module for that many partitions (see the *_P4 configs).
+cd `dirname $0`
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 <partitions> <config> [options]" >&2
+    exit 2
+fi
+P=$1
+CONFIG=$2
+shift 2
+
+mkdir -p results
+pids=""
+p=0
+while [ $p -lt $P ]; do
+    ./run -u Cmdenv -c $CONFIG -p$p,$P "$@" > results/$CONFIG-p$p.log 2>&1 &
+    pids="$pids $!"
+    p=`expr $p + 1`
+done
+
+status=0
+for pid in $pids; do
+    wait $pid || status=1
+done
+exit $status
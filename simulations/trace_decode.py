@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+#
+# Decode the binary trace files written by the chord nodes and clients (see
+# src/Trace.h and the traceLevel parameter) into text, one line per record:
+#
+#   <time> <module> <event> <a> <b>
+#
+# Records of several files are merged in time order. The files describe
+# themselves: the header carries the event names, the simtime scale and the
+# path of the module that wrote it.
+#
+# usage: trace_decode.py [--event NAME ...] [--level N] [--csv] [--summary]
+#                        FILE...
+
+import argparse
+import heapq
+import struct
+import sys
+
+MAGIC = b'CHRDTRCE'
+VERSION = 1
+
+# time, event, level, a, b
+RECORD = struct.Struct ('<qIIqq')
+
+
+class TraceFile:
+    """One trace file: its header and an iterator over its records."""
+
+    def __init__ (self, filename):
+        self.filename = filename
+        self.f = open (filename, 'rb')
+        if self.f.read (len (MAGIC)) != MAGIC:
+            raise ValueError ('%s: not a chord trace file' % filename)
+        version, self.scale_exp, record_size, num_events = struct.unpack ('<IiII', self.f.read (16))
+        if version != VERSION:
+            raise ValueError ('%s: trace version %d, expected %d' % (filename, version, VERSION))
+        if record_size != RECORD.size:
+            raise ValueError ('%s: records of %d bytes, expected %d' % (filename, record_size, RECORD.size))
+        self.events = []
+        for _ in range (num_events):
+            n = self.f.read (1)[0]
+            self.events.append (self.f.read (n).decode ())
+        n, = struct.unpack ('<I', self.f.read (4))
+        self.module = self.f.read (n).decode ()
+
+    def event_name (self, event):
+        return self.events[event] if event < len (self.events) else 'event%d' % event
+
+    def records (self):
+        """Yield (time in seconds, module, event name, level, a, b)."""
+        scale = 10.0 ** self.scale_exp
+        while True:
+            buf = self.f.read (RECORD.size * 4096)
+            if not buf:
+                break
+            for t, event, level, a, b in RECORD.iter_unpack (buf[:len (buf) - len (buf) % RECORD.size]):
+                yield (t * scale, self.module, self.event_name (event), level, a, b)
+
+
+def main ():
+    parser = argparse.ArgumentParser (description='decode chord trace files')
+    parser.add_argument ('files', nargs='+', help='trace files')
+    parser.add_argument ('--event', action='append', help='only these events (repeatable)')
+    parser.add_argument ('--level', type=int, help='only records up to this level')
+    parser.add_argument ('--csv', action='store_true', help='comma separated output')
+    parser.add_argument ('--summary', action='store_true', help='count the records per module and event instead')
+    args = parser.parse_args ()
+
+    traces = [TraceFile (f) for f in args.files]
+    events = set (args.event) if args.event else None
+
+    # the records of each file are in time order already
+    merged = heapq.merge (*[t.records () for t in traces], key=lambda r: r[0])
+
+    counts = {}
+    sep = ',' if args.csv else ' '
+    if args.csv and not args.summary:
+        print ('time,module,event,a,b')
+    for time, module, event, level, a, b in merged:
+        if events is not None and event not in events:
+            continue
+        if args.level is not None and level > args.level:
+            continue
+        if args.summary:
+            counts[(module, event)] = counts.get ((module, event), 0) + 1
+            continue
+        print (sep.join (('%.9f' % time, module, event, str (a), str (b))))
+
+    if args.summary:
+        for (module, event), n in sorted (counts.items ()):
+            print ('%-50s %-22s %10d' % (module, event, n))
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit (main ())
+    except BrokenPipeError:
+        sys.exit (0)
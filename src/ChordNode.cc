@@ -8,12 +8,17 @@
  *
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 using namespace std;
 
 #include "inet/common/INETEndians.h"  // for host/network byte ordering
 #include "inet/networklayer/common/L3AddressResolver.h"
+#include "inet/transportlayer/contract/udp/UDPControlInfo_m.h" // where a datagram came from
 
 #include "ChordP2PMsg_m.h"     // generated header from the message file
 #include "ChordNode.h"         // our header
@@ -24,25 +29,88 @@ using namespace inet;
 // register the module with Omnet++
 Define_Module(ChordNode);
 
+// signals for the per hop latency breakdown
+simsignal_t ChordNode::hopTimeSignal = registerSignal("hopTime");
+simsignal_t ChordNode::queueTimeSignal = registerSignal("queueTime");
+simsignal_t ChordNode::connSetupTimeSignal = registerSignal("connSetupTime");
+simsignal_t ChordNode::storeTimeSignal = registerSignal("storeTime");
+simsignal_t ChordNode::maintenanceBytesSignal = registerSignal("maintenanceBytes");
+simsignal_t ChordNode::peerSuspectedSignal = registerSignal("peerSuspected");
+
 // constructor and destructors
 ChordNode::ChordNode (void)
-    : myID_ (-1),
+    : helper_ (nullptr),
+      myID_ (-1),
+      hostIndex_ (-1),
       localAddress_ (),
       localPort_ (10000),
-      finger_table_size_ (0),
-      nodeList_ (),
-      ft_ (NULL),
+      m_ (0),
+      nodeList_ (nullptr),
+      transport_ (Helper::TCP),
+      latency_ (nullptr),
+      gateway_ (nullptr),
+      vnodes_ (),
+      routing_ (nullptr),
+      rtt_ (),
+      vivaldi_ (),
+      trace_ (),
+      connPool_ (),
       socket_ (nullptr),
       socketMap_ (),
-      callerID ()
-      //socketStackMap_ ()
+      callerMap_ (),
+      nextCallerID_ (0),
+      callerLifetime_ (),
+      pendingMap_ (),
+      connectStartedAt_ (),
+      lazyConnect_ (false),
+      maxConnects_ (0),
+      deferredConnects_ (),
+      connectsDeferred_ (0),
+      load_ (nullptr),
+      store_ (nullptr),
+      storeJobs_ (),
+      storeTimer_ (nullptr),
+      storeBusyUntil_ (),
+      kvGets_ (0),
+      kvGetHits_ (0),
+      kvPuts_ (0),
+      kvDeletes_ (0),
+      peakStoreBytes_ (0),
+      replicationFactor_ (0),
+      replicaRead_ (ChordNode::OWNER_READ),
+      replicaUpdates_ (0),
+      replicaGets_ (0),
+      up_ (true),
+      stabilizeInterval_ (),
+      stabilizeTimer_ (nullptr),
+      messagesDropped_ (0),
+      maintenanceMsgs_ (0),
+      maintenanceBytes_ (0),
+      failureDetector_ (false),
+      suspectMinTimeout_ (),
+      suspectInitialTimeout_ (),
+      suspectPeriod_ (),
+      maxReroutes_ (0),
+      successorListSize_ (1),
+      nextHopID_ (0),
+      watchedHops_ (),
+      suspects_ (),
+      hopsWatched_ (0),
+      hopAcks_ (0),
+      suspicions_ (0),
+      suspicionsCleared_ (0),
+      reroutes_ (0),
+      reroutesAbandoned_ (0)
 {
     // nothing
 }
 
 ChordNode::~ChordNode()
 {
-    // nothing
+    delete this->routing_;
+    delete this->store_;
+    if (this->helper_)
+        Helper::release ();
 }
 
 /* implement the three required methods */
@@ -61,44 +129,120 @@ void ChordNode::initialize (int stage)
     // for ourselves. Thereafter, we initialize our finger table and open connections
     // to our finger nodes
 
+    // the helper of our process; in a parallel run every process has its own
+    this->helper_ = Helper::acquire ();
+
     // obtain the values of parameters
     this->localPort_ = this->par ("localPort").longValue ();
-    this->finger_table_size_ = helper->num_bits ();
-
-    // get the node list
-    helper->chord_node_list (this->nodeList_);
-
-    // we use our simulation assigned ID modulo the number of
-    // chord nodes as an index into the node array and assign ourselves that ID. But
-    // what I have observed is that although the IDs are unique, their modulo
-    // may result in same value. So I am using a hack by combinining my ID plus
-    // parent ID and hoping that it gives a unique number. Somehow we need a unique
-    // number
+    this->callerLifetime_ = this->par ("callerLifetime").doubleValue ();
+    this->lazyConnect_ = this->par ("lazyConnect").boolValue ();
+    this->maxConnects_ = this->par ("maxConnectsInProgress").longValue ();
+    this->trace_.open (this, this->par ("traceLevel").longValue (),
+                       this->par ("traceFile").stdstringValue (),
+                       this->par ("traceBufferSize").longValue (),
+                       this->par ("traceWrap").boolValue ());
+    this->m_ = this->helper_->num_bits ();
+    this->store_ = new KVStore (this->par ("storeInitialSlots").longValue ());
+    this->storeTimer_ = new cMessage ("store_done", 3);
+    this->stabilizeInterval_ = this->par ("stabilizeInterval").doubleValue ();
+    this->stabilizeTimer_ = new cMessage ("stabilize", 4);
+    this->failureDetector_ = this->par ("failureDetector").boolValue ();
+    this->suspectMinTimeout_ = this->par ("suspectMinTimeout").doubleValue ();
+    this->suspectInitialTimeout_ = this->par ("suspectInitialTimeout").doubleValue ();
+    this->suspectPeriod_ = this->par ("suspectPeriod").doubleValue ();
+    this->maxReroutes_ = this->par ("maxReroutes").longValue ();
+    this->successorListSize_ = this->par ("successorListSize").longValue ();
+    if (this->successorListSize_ < 1)
+        throw cRuntimeError ("ChordNode::initialize -- successorListSize must be at least 1, not %d",
+                             this->successorListSize_);
+    if (this->par ("vivaldi").boolValue ())
+        this->vivaldi_.init (this->par ("vivaldiDimensions").longValue (), this->par ("vivaldiCc").doubleValue (),
+                             this->par ("vivaldiCe").doubleValue (), getRNG (0));
+    this->replicationFactor_ = this->par ("replicationFactor").longValue ();
+    string replicaRead = this->par ("replicaRead").stdstringValue ();
+    if (replicaRead == "owner")
+        this->replicaRead_ = ChordNode::OWNER_READ;
+    else if (replicaRead == "path")
+        this->replicaRead_ = ChordNode::PATH_READ;
+    else if (replicaRead == "closest")
+        this->replicaRead_ = ChordNode::CLOSEST_READ;
+    else
+        throw cRuntimeError ("ChordNode::initialize -- unknown replica read policy \"%s\"", replicaRead.c_str ());
+    this->transport_ = Helper::parse_transport (this->par ("transport").stdstringValue ());
+    if (this->transport_ == Helper::UDP && !gate ("udpOut")->isConnected ())
+        throw cRuntimeError ("ChordNode::initialize -- the UDP transport needs us in the host's udpApp[] "
+                             "(set the host's transport parameter too)");
+    if (this->transport_ == Helper::OVERLAY) {
+        this->latency_ = LatencyModel::local (this->par ("latencyModel").stringValue ());
+        if (!this->latency_)
+            throw cRuntimeError ("ChordNode::initialize -- overlay transport needs a LatencyModel module \"%s\"",
+                                 this->par ("latencyModel").stringValue ());
+        this->gateway_ = OverlayGateway::local (this->par ("overlayGateway").stringValue ());
+        if (!this->gateway_)
+            throw cRuntimeError ("ChordNode::initialize -- overlay transport needs an OverlayGateway module \"%s\"",
+                                 this->par ("overlayGateway").stringValue ());
+    }
 
-    this->myID_
-    = this->nodeList_[this->getParentModule()->getId () % helper->num_chord_nodes()];
+    // get the node list (the helper hands it out in sorted order)
+    this->nodeList_ = &this->helper_->chord_node_list ();
+    this->routing_ = RoutingTable::create (this->par ("routingTable").stdstringValue (), this, this,
+                                           *this->nodeList_, this->m_);
+
+    // we use the index of our host in the chordHosts[] vector to ask the
+    // helper for the IDs of the virtual nodes we run. Unlike the simulation
+    // assigned module ID, the vector index is guaranteed to be unique and
+    // within range, so no two hosts end up with the same chord ID.
+    this->hostIndex_ = this->getParentModule()->getIndex () % this->helper_->num_chord_nodes();
+    Helper::IDVector ids;
+    this->helper_->host_node_ids (this->hostIndex_, ids);
+    this->myID_ = ids[0];
+
+    for (Helper::IDVector::iterator it = ids.begin (); it != ids.end (); ++it) {
+        ChordNode::VirtualNode vn;
+        vn.id = *it;
+        this->vnodes_.push_back (vn);
+    }
+    this->update_neighbours ();
+
+    // the ring is static and known to all, so our routing table is loaded
+    // right away: from a snapshot of an earlier run if we have one, or
+    // else built (chord finger tables take their rows from the successor
+    // table the helper sweeps out once for all the nodes)
+    string snapshotIn = this->par ("snapshotIn").stdstringValue ();
+    if (!snapshotIn.empty ())
+        this->restore_snapshot (this->helper_->snapshot_in (snapshotIn), ids);
+    else
+        this->routing_->build (ids);
 
     // To retrieve our IP address, we ask the resolver to get the underlying IP address
     // associated with the host on which this application is running. That host is found
-    // by accessing our parent module.
-    L3AddressResolver resolver;
-    this->localAddress_ = resolver.resolve (this->getParentModule()->getFullName());
+    // by accessing our parent module. The overlay transport has no IP layer and
+    // reaches us through our overlay address instead.
+    if (this->transport_ != Helper::OVERLAY) {
+        L3AddressResolver resolver;
+        this->localAddress_ = resolver.resolve (this->getParentModule()->getFullName());
+    }
 
-    // now register ourselves with helper database
-    helper->register_node (this->myID_, this->localAddress_);
+    // now register all our virtual nodes with helper database
+    for (VirtualNodeVector::iterator it = this->vnodes_.begin (); it != this->vnodes_.end (); ++it)
+        this->helper_->register_node (it->id, this->localAddress_);
 
-    // allocate space for our finger table
-    this->ft_ = new ChordNode::Fingertable [this->finger_table_size_];
-    if (!this->ft_) {
-        throw cRuntimeError("ChordNode::initialize -- no memory for finger table");
-        return;
-    }
+    // the overlay address of a chord host is its index. The partition-id
+    // settings of a parallel run must put us where the helper expects us.
+    if (this->helper_->partition_of (this->hostIndex_) != getSimulation ()->getParsimProcId ())
+        throw cRuntimeError ("ChordNode::initialize -- chordHosts[%d] is in partition %d, expected %d",
+                             this->hostIndex_, getSimulation ()->getParsimProcId (),
+                             this->helper_->partition_of (this->hostIndex_));
+    this->helper_->register_endpoint (this->hostIndex_, this->getId ());
+    this->load_ = this->helper_->node_load (this->hostIndex_);
 
     EV << "=== ChordNode::initialize (stage " << stage << ")" << endl
             << "\tmyID_ = " << this->myID_ << endl
+            << "\tvirtual nodes = " << this->vnodes_.size () << endl
             << "\tlocalAddess = " << this->localAddress_.str () << endl
             << "\tlocalPort = " << this->localPort_ << endl
-            << "\tm = " << this->finger_table_size_ << endl;
+            << "\tm = " << this->m_ << endl
+            << "\trouting table = " << this->par ("routingTable").stdstringValue () << endl;
 
     // we start a timer so that we can initialize our socket
     cMessage *timer_msg = new cMessage ("init_socket", 0);
@@ -112,14 +256,27 @@ void ChordNode::initialize (int stage)
 /** the all serving handle message method */
 void ChordNode::handleMessage (cMessage *msg)
 {
-    EV << "=== ChordNode::handleMessage " << this->myID_
-       << " received handleMessage message"
-       << endl;
+    // while our host is off the ring (churn) nothing gets through to us
+    if (!this->up_ && !msg->isSelfMessage ()) {
+        this->messagesDropped_++;
+        delete msg;
+        return;
+    }
 
     // check if this was a self generated message, such as a timeout to wake us
     // up to initialize ourselves
     if (msg->isSelfMessage ()) {
         this->handleTimer (msg);
+    } else if (this->transport_ == Helper::OVERLAY) {
+        // the overlay transport hands us the chord message itself; replies go
+        // straight back to the sending module
+        Chord_Msg *cmsg = dynamic_cast<Chord_Msg *> (msg);
+        if (!cmsg)
+            throw cRuntimeError("ChordNode::handleMessage -- not a chord message");
+        CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_MSG_ARRIVED, -1, cmsg->getByteLength ());
+        this->handle_chord_msg (cmsg, ChordNode::Link (nullptr, cmsg->getSrcAddress ()));
+    } else if (this->transport_ == Helper::UDP) {
+        this->udp_arrived (msg);
     } else {
         // let the socket class process the message and make a call back on the
         // appropriate method. But note that we need to determine which socket
@@ -139,12 +296,7 @@ void ChordNode::handleMessage (cMessage *msg)
             if (!cmd) {
                 throw cRuntimeError("ChordNode::handleMessage: no TCPCommand control info in message (not from TCP?)");
             } else {
-                EV << "=== ChordNode:: " << this->myID_
-                   << " **No socket yet ** for connID: "
-                   << cmd->getConnId ()
-                   << ", setting transfer mode to "
-                   << this->socket_->getDataTransferMode()
-                   << "===" << endl;
+                CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_ACCEPTED, cmd->getConnId (), 0);
 
                 // notice that we must use the other constructor of TCPSocket
                 // so that it will use the underlying connID that was created
@@ -163,6 +315,7 @@ void ChordNode::handleMessage (cMessage *msg)
 
                 // now save this socket in our map
                 this->socketMap_.addSocket (new_socket);
+                this->update_socket_count ();
 
                 // process the message on this socket
                 new_socket->processMessage (msg);
@@ -179,10 +332,97 @@ void ChordNode::finish ()
 {
     EV << "=== ChordNode::finish called" << endl;
 
+    // record our share of the load
+    recordScalar ("requestsOwned", this->load_->requestsOwned);
+    recordScalar ("requestsForwarded", this->load_->requestsForwarded);
+    recordScalar ("bytesIn", this->load_->bytesIn);
+    recordScalar ("bytesOut", this->load_->bytesOut);
+    recordScalar ("messagesOut", this->load_->messagesOut);
+    recordScalar ("peakOpenSockets", this->load_->peakSockets);
+    if (this->routing_->built ()) {
+        Helper::IDVector peers;
+        this->routing_->peers (peers);
+        recordScalar ("routingStateSize", this->routing_->state_size ());
+        recordScalar ("routingPeers", peers.size ());
+        this->routing_->record_scalars (this);
+    }
+    if (this->rtt_.num_samples () > 0)
+        recordScalar ("rttSamples", this->rtt_.num_samples ());
+    if (this->vivaldi_.enabled ()) {
+        recordScalar ("vivaldiSamples", this->vivaldi_.num_samples ());
+        recordScalar ("vivaldiKnownHosts", this->vivaldi_.num_known ());
+        recordScalar ("vivaldiError", this->vivaldi_.error ());
+        recordScalar ("vivaldiSampleError", this->vivaldi_.mean_sample_error ());
+    }
+    if (this->helper_->churn_active ()) {
+        recordScalar ("messagesDropped", this->messagesDropped_);
+        recordScalar ("maintenanceMessages", this->maintenanceMsgs_);
+        recordScalar ("maintenanceBytes", this->maintenanceBytes_);
+    }
+    if (this->maxConnects_ > 0)
+        recordScalar ("connectsDeferred", this->connectsDeferred_);
+    if (this->failureDetector_) {
+        recordScalar ("hopsWatched", this->hopsWatched_);
+        recordScalar ("peerSuspicions", this->suspicions_);
+        recordScalar ("suspicionsCleared", this->suspicionsCleared_);
+        recordScalar ("lookupsRerouted", this->reroutes_);
+        recordScalar ("reroutesAbandoned", this->reroutesAbandoned_);
+    }
+    if (this->hopAcks_ > 0)
+        recordScalar ("hopAcksSent", this->hopAcks_);
+    if (this->trace_.enabled (TRACE_LOOKUP)) {
+        recordScalar ("traceRecords", this->trace_.num_records ());
+        recordScalar ("traceOverwritten", this->trace_.num_overwritten ());
+    }
+    this->trace_.close ();
+    if (this->kvGets_ + this->kvPuts_ + this->kvDeletes_ > 0) {
+        recordScalar ("kvGets", this->kvGets_);
+        recordScalar ("kvGetHits", this->kvGetHits_);
+        recordScalar ("kvPuts", this->kvPuts_);
+        recordScalar ("kvDeletes", this->kvDeletes_);
+        recordScalar ("storedKeys", this->store_->size ());
+        recordScalar ("storedBytes", this->store_->bytes ());
+        recordScalar ("peakStoredBytes", this->peakStoreBytes_);
+        recordScalar ("storeArenaBytes", this->store_->arena_bytes ());
+    }
+    if (this->replicationFactor_ > 0) {
+        recordScalar ("replicaUpdates", this->replicaUpdates_);
+        recordScalar ("replicaGets", this->replicaGets_);
+    }
+
+    // leave the state of the ring for later runs
+    string snapshotOut = this->par ("snapshotOut").stdstringValue ();
+    if (!snapshotOut.empty ()) {
+        RingSnapshot &snap = this->helper_->snapshot_out (this->par ("routingTable").stdstringValue ());
+        RingSnapshot::HostState &hs = snap.hosts[this->hostIndex_];
+        this->routing_->save (hs.routing);
+        this->store_->entries (hs.store);
+        this->helper_->snapshot_done (snapshotOut);
+    }
+
+    // answers the store never got to
+    for (StoreJobQueue::iterator it = this->storeJobs_.begin (); it != this->storeJobs_.end (); ++it)
+        delete it->resp;
+    this->storeJobs_.clear ();
+    cancelAndDelete (this->storeTimer_);
+    this->storeTimer_ = nullptr;
+    cancelAndDelete (this->stabilizeTimer_);
+    this->stabilizeTimer_ = nullptr;
+    this->forget_watched_hops ();
+
+    // drop whatever was still waiting for a connection
+    for (PendingMap::iterator it = this->pendingMap_.begin (); it != this->pendingMap_.end (); ++it) {
+        for (PendingQueue::iterator pit = it->second.begin (); pit != it->second.end (); ++pit)
+            delete pit->msg;
+    }
+    this->pendingMap_.clear ();
+    this->callerMap_.clear ();
+
     // cleanup all the sockets
+    this->deferredConnects_.clear ();
     this->socketMap_.deleteSockets ();
-
-    std::string modulePath = getFullPath();
+    this->socket_ = nullptr;
+    this->connPool_.clear ();
 }
 
 /** handle the timeout method */
@@ -191,8 +431,17 @@ void ChordNode::handleTimer (cMessage *msg)
     // The way we have programmed this, we can get two kinds of timer expiry:
     // first is when we must create a listening socket (when kind == 0)
     // second is when we must create our finger table (when kind == 1)
-    
-    if (msg->getKind () == 0) {
+    // The store's timer (kind == 3) and the stabilization timer (kind == 4)
+    // are ours to reuse and are not deleted. The ack timer of a forwarded
+    // lookup (kind == 5) is deleted by hop_timeout.
+
+    if (msg->getKind () == 3) {
+        this->store_timer ();
+    } else if (msg->getKind () == 4) {
+        this->stabilize ();
+    } else if (msg->getKind () == 5) {
+        this->hop_timeout (msg);
+    } else if (msg->getKind () == 0) {
         // this is a init_socket time out
         EV << "=== ChordNode::handleTimer for Node ID: " << this->myID_
            << " being kickstarted to initialize socket ===" << endl;
@@ -201,35 +450,42 @@ void ChordNode::handleTimer (cMessage *msg)
         // clean up the timer msg
         delete msg;
 
-        // now initialize the listening socket
-        
-        // create a new socket for the listening role.
-        this->socket_ = new TCPSocket ();
-        if (!this->socket_)
-            throw cRuntimeError("ChordNode::initialize: no memory for socket");
-
-        // message transfer
-        this->socket_->setDataTransferMode (TCP_TRANSFER_OBJECT);
-
-        // In the server role, we bind ourselves to the well-defined port and IP
-        // address on which we listen for incoming connections.
-        this->socket_->bind (this->localAddress_, this->localPort_);
-
-        // register ourselves as the callback object. Note the second param is
-        // whatever pointer we want to send that will help us when the callback
-        // happens. So we send a pointer to the socket itself so it is readily
-        // available to us
-        this->socket_->setCallbackObject (this, this->socket_);
-
-        // do not forget to set the outgoing gate
-        this->socket_->setOutputGate (gate ("tcpOut"));
-
-        // now save this socket in our map
-        this->socketMap_.addSocket (this->socket_);
-
-        // now listen for incoming connections.  This version is the forking
-        // version where upon every new incoming connection, a new socket is created.
-        this->socket_->listen ();
+        // now initialize the listening socket (the overlay transport needs none)
+        if (this->transport_ == Helper::UDP) {
+            // datagrams need no connections: one socket bound to our port
+            // serves clients and fingers alike
+            this->udpSocket_.setOutputGate (gate ("udpOut"));
+            this->udpSocket_.bind (this->localPort_);
+        } else if (this->transport_ == Helper::TCP) {
+            // create a new socket for the listening role.
+            this->socket_ = new TCPSocket ();
+            if (!this->socket_)
+                throw cRuntimeError("ChordNode::initialize: no memory for socket");
+
+            // message transfer
+            this->socket_->setDataTransferMode (TCP_TRANSFER_OBJECT);
+
+            // In the server role, we bind ourselves to the well-defined port and IP
+            // address on which we listen for incoming connections.
+            this->socket_->bind (this->localAddress_, this->localPort_);
+
+            // register ourselves as the callback object. Note the second param is
+            // whatever pointer we want to send that will help us when the callback
+            // happens. So we send a pointer to the socket itself so it is readily
+            // available to us
+            this->socket_->setCallbackObject (this, this->socket_);
+
+            // do not forget to set the outgoing gate
+            this->socket_->setOutputGate (gate ("tcpOut"));
+
+            // now save this socket in our map
+            this->socketMap_.addSocket (this->socket_);
+            this->update_socket_count ();
+
+            // now listen for incoming connections.  This version is the forking
+            // version where upon every new incoming connection, a new socket is created.
+            this->socket_->listen ();
+        }
 
         setStatusString ("passively waiting");
 
@@ -253,6 +509,11 @@ void ChordNode::handleTimer (cMessage *msg)
         // call a helper method that will fill up the finger table for this node
         this->init_finger_table ();
 
+        // with churn, the virtual nodes check their successors from now on;
+        // spread the rounds of the hosts over the interval
+        if (this->stabilizeInterval_ > SIMTIME_ZERO)
+            this->scheduleAt (simTime () + uniform (0, this->stabilizeInterval_.dbl ()), this->stabilizeTimer_);
+
         setStatusString ("finger table init");
 
     } else {
@@ -267,11 +528,20 @@ void ChordNode::handleTimer (cMessage *msg)
 
 void ChordNode::socketEstablished (int connID, void *yourPtr)
 {
-    EV << "=== ChordNode::socketEstablished: " << this->myID_
-       << " received socketEstablished message on connID "
-       << connID << " ===" << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_ESTABLISHED, connID, 0);
 
     setStatusString("ConnectionEstablished");
+
+    // if we were the ones connecting, this completes the connection set up
+    map<int, simtime_t>::iterator it = this->connectStartedAt_.find (connID);
+    if (it != this->connectStartedAt_.end ()) {
+        this->emit (ChordNode::connSetupTimeSignal, simTime () - it->second);
+        this->connectStartedAt_.erase (it);
+        this->next_connect ();
+    }
+
+    // now send whatever was waiting for this connection
+    this->flush_pending (static_cast<TCPSocket *> (yourPtr));
 }
 
 /** handle incoming data, which ought to be a request */
@@ -279,10 +549,7 @@ void ChordNode::socketDataArrived(int connID, void *yourPtr, cPacket *msg, bool)
 {
     // debugging output
     setStatusString ("Request");
-    EV << "=== ChordNode::socketDataArrived: " << this->myID_
-       << " received socketDataArrived message. on connID: " << connID
-       << " of byte length = " << msg->getByteLength ()
-       << " ===" << endl; 
+    CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_MSG_ARRIVED, connID, msg->getByteLength ());
 
     // first cast to the socket on which this message was received
     TCPSocket *socket = static_cast<TCPSocket *> (yourPtr);
@@ -291,14 +558,17 @@ void ChordNode::socketDataArrived(int connID, void *yourPtr, cPacket *msg, bool)
         return;
     }
 
-    /* @@@ FILL IN @@@ */
-
     // incoming msg has to be a lookup request either coming directly
     // from a client or from another chord node. Or it can be a response
     // from another finger that we must relayed back to client. We must cast
     // the msg to the appropriate type and take actions.
+    Chord_Msg *cmsg = dynamic_cast<Chord_Msg *> (msg);
+    if (!cmsg) {
+        throw cRuntimeError("ChordNode::socketDataArrived -- not a chord message");
+        return;
+    }
 
-
+    this->handle_chord_msg (cmsg, ChordNode::Link (socket));
 }
 
 void ChordNode::socketPeerClosed (int connID, void *yourPtr)
@@ -307,10 +577,7 @@ void ChordNode::socketPeerClosed (int connID, void *yourPtr)
     // lookup request to us, which has closed its connection.
     // So we proceed to cleanup our end of the connection by
     // cleanup up the socket.
-    EV << "=== ChordNode::socketPeerClosed: " << this->myID_
-       << " received socketPeerClosed message"
-       << endl; 
-    EV << "client closed for connID = " << connID << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_CLOSED, connID, 1);
 
     // we should close the socket corresponding to the peer and delete from socket map
     TCPSocket *socket = static_cast<TCPSocket *> (yourPtr);
@@ -326,10 +593,7 @@ void ChordNode::socketPeerClosed (int connID, void *yourPtr)
 
 void ChordNode::socketClosed (int connID, void *yourPtr)
 {
-    EV << "=== ChordNode::socketClosed: " << this->myID_
-       << " received socketClosed message"
-       << endl; 
-    EV << "connection closed\n";
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_CLOSED, connID, 0);
     setStatusString("closed");
 
     // we are closed :-) so we must remove ourselves from the socket map
@@ -342,18 +606,17 @@ void ChordNode::socketClosed (int connID, void *yourPtr)
     }
 
     // remove from socket map and delete it
+    this->forget_socket (socket);
     this->socketMap_.removeSocket (socket);
+    this->update_socket_count ();
     delete socket;
 }
 
-void ChordNode::socketFailure (int, void *yourPtr, int code)
+void ChordNode::socketFailure (int connID, void *yourPtr, int code)
 {
-    EV << "=== ChordNode::socketFailure " << this->myID_
-       << " received socketFailure message"
-       << endl; 
     // subclasses may override this function, and add code try to reconnect
     // after a delay. 
-    EV << "connection broken\n";
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_FAILED, connID, code);
     setStatusString("broken");
 
     TCPSocket *socket = static_cast<TCPSocket *> (yourPtr);
@@ -363,7 +626,9 @@ void ChordNode::socketFailure (int, void *yourPtr, int code)
     }
 
     // remove from socket map and delete it
+    this->forget_socket (socket);
     this->socketMap_.removeSocket (socket);
+    this->update_socket_count ();
     delete socket;
 }
 
@@ -372,132 +637,1082 @@ void ChordNode::socketFailure (int, void *yourPtr, int code)
 /**********************************************************************/
 
 //@{
-/** build the finger table for this node */
-void ChordNode::init_finger_table ()
+/** load our routing table and store from a ring snapshot */
+void ChordNode::restore_snapshot (const RingSnapshot &snap, const Helper::IDVector &ids)
 {
-    //* @@@ FILL IN @@@ */
-    // write the logic to fill up the finger table
+    string routingTable = this->par ("routingTable").stdstringValue ();
+    if (snap.routingTable != routingTable)
+        throw cRuntimeError ("ChordNode::restore_snapshot -- the snapshot has a \"%s\" routing table, we use \"%s\"",
+                             snap.routingTable.c_str (), routingTable.c_str ());
+    RingSnapshot::HostMap::const_iterator it = snap.hosts.find (this->hostIndex_);
+    if (it == snap.hosts.end ())
+        throw cRuntimeError ("ChordNode::restore_snapshot -- the snapshot has no state for host %d", this->hostIndex_);
+
+    // tables that saved nothing are built afresh
+    if (!this->routing_->restore (ids, it->second.routing))
+        this->routing_->build (ids);
+
+    for (vector<KVStore::Entry>::const_iterator kit = it->second.store.begin (); kit != it->second.store.end (); ++kit)
+        this->store_->put (kit->first, kit->second);
+    this->peakStoreBytes_ = this->store_->bytes ();
+
+    EV << "=== ChordNode::restore_snapshot NodeID: " << this->myID_
+       << " routing state = " << this->routing_->state_size ()
+       << " entries, " << this->store_->size () << " keys" << endl;
+}
 
-    // Get size of finger table and generate it.
-    int m = this->finger_table_size_;
-    Fingertable table[m];
-    this->ft_ = table;
-    for(int i=0; i<m; i++){
-        // Use mod for situation when it exceeds pow(2, m)
-        int id = ((this->myID_ + (int)pow(2, i)) % (int)pow(2, m));
-        int suc = this->successor(id);
-        (this->ft_ + i)->fingerID = suc;
-        (this->ft_ + i)->socket = this->connect(suc);
+/** open the links to the peers in our routing table */
+void ChordNode::init_finger_table ()
+{
+    // one table, built in initialize, covers all our virtual nodes. Peers
+    // that are our own virtual nodes need no connection at all, and peers
+    // living on the same remote host share one connection from the pool.
+    // With lazy connections we leave it to the first message to a peer.
+    Helper::IDVector peers;
+    this->routing_->peers (peers);
+    for (Helper::IDVector::iterator it = peers.begin (); it != peers.end () && !this->lazyConnect_; ++it) {
+        if (!this->is_local (*it))
+            this->node_link (*it);
     }
+
+    EV << "=== ChordNode::init_finger_table NodeID: " << this->myID_
+       << " routing state = " << this->routing_->state_size ()
+       << " entries, " << peers.size () << " peers" << endl;
 }
 
 // connect to our finger node
-inet::TCPSocket *ChordNode::connect (int fingerID)
+inet::TCPSocket *ChordNode::connect (Helper::NodeID fingerID)
 {
-    //* @@@ FILL IN @@@ */
     // this method is to be used when initializing the finger table where we
     // connect to each of our fingers. Note the parameter is
     // the ID. So use the helper class' method to get the IP addr of the node
-    // corresponding to this node ID. All other steps are similar to how
-    // we create a new socket. Do not forget to use this class as the callback
-    // object.
-    EV << "=== ChordNode::connect NodeID: " << this->myID_
-       << " connect to the chord node with ID" << fingerID << endl;
-
-    // Create a new socket and connect to it from local socket
-    inet::L3Address addr = helper->lookup_node(fingerID);
+    // corresponding to this node ID.
+    inet::L3Address addr = this->helper_->lookup_node(fingerID);
+    if (addr.isUnspecified ())
+        throw cRuntimeError("ChordNode::connect -- no address registered for node %lld",
+                            (long long) fingerID);
+
+    // Create a new socket in the connecting role. Our listening socket stays
+    // as it is.
     inet::TCPSocket *new_socket = new TCPSocket ();
+    new_socket->setDataTransferMode (TCP_TRANSFER_OBJECT);
+    new_socket->setOutputGate (gate ("tcpOut"));
+    new_socket->setCallbackObject (this, new_socket);
+
+    // the socket must be in our map so that the replies find their way to it
+    this->socketMap_.addSocket (new_socket);
+    this->update_socket_count ();
+
+    this->connPool_[addr] = new_socket;
+
+    // Messages to the peer wait for the connection either way. If there are
+    // too many connects in progress already, so does the connect itself.
+    if (this->maxConnects_ > 0 && (int) this->connectStartedAt_.size () >= this->maxConnects_) {
+        ChordNode::DeferredConnect dc;
+        dc.socket = new_socket;
+        dc.addr = addr;
+        this->deferredConnects_.push_back (dc);
+        this->connectsDeferred_++;
+        CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_CONNECT, fingerID, 1);
+    } else {
+        CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_CONNECT, fingerID, 0);
+        this->start_connect (new_socket, addr);
+    }
+
+    return new_socket;
+}
+
+/** issue the connect of a socket */
+void ChordNode::start_connect (inet::TCPSocket *socket, const inet::L3Address &addr)
+{
+    socket->connect (addr, this->localPort_);
+    this->connectStartedAt_[socket->getConnectionId ()] = simTime ();
+}
+
+/** issue deferred connects while we are below the limit */
+void ChordNode::next_connect (void)
+{
+    while (!this->deferredConnects_.empty ()
+           && (int) this->connectStartedAt_.size () < this->maxConnects_) {
+        ChordNode::DeferredConnect dc = this->deferredConnects_.front ();
+        this->deferredConnects_.pop_front ();
+        this->start_connect (dc.socket, dc.addr);
+        CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_CONNECT_STARTED,
+                     dc.socket->getConnectionId (), this->deferredConnects_.size ());
+    }
+}
+
+/** link to the host running the given node, connecting first if needed */
+ChordNode::Link ChordNode::node_link (Helper::NodeID nodeID)
+{
+    if (this->transport_ == Helper::OVERLAY)
+        return ChordNode::Link (nullptr, this->helper_->node_host (nodeID));
+    if (this->transport_ == Helper::UDP)
+        return ChordNode::Link (this->helper_->lookup_node (nodeID), this->localPort_);
+
+    ConnectionPool::iterator it = this->connPool_.find (this->helper_->lookup_node (nodeID));
+    if (it != this->connPool_.end ())
+        return ChordNode::Link (it->second);
+    return ChordNode::Link (this->connect (nodeID));
+}
+
+/** handle a chord message that arrived from the given link */
+void ChordNode::handle_chord_msg (Chord_Msg *cmsg, const ChordNode::Link &from)
+{
+    // time this message spent in transit from the previous hop
+    simtime_t transit = simTime () - cmsg->getHopSentTS ();
+    this->emit (ChordNode::hopTimeSignal, transit);
+
+    // An answer from a chord node times the round trip to it: it left us
+    // at the time it echoes, and the node held it for the time it says.
+    int src = cmsg->getSrcAddress ();
+    bool fromPeer = src >= 0 && src < this->helper_->num_chord_nodes () && src != this->hostIndex_;
+    simtime_t rtt = -1;
+    if (fromPeer) {
+        if (cmsg->getEchoTS () >= SIMTIME_ZERO) {
+            rtt = simTime () - cmsg->getEchoTS () - cmsg->getEchoHeld ();
+            this->rtt_.sample (src, rtt);
+        }
+
+        // a host we hear from is alive after all
+        if (!this->suspects_.empty () && this->suspects_.erase (src) > 0) {
+            CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_PEER_CLEARED, src, 0);
+            this->suspicionsCleared_++;
+        }
+    }
+    this->load_->bytesIn += cmsg->getByteLength ();
+
+    // lookups and their answers carry the coordinates of the chord node
+    // that sent them on, and answers those of the node that answered; an
+    // answer timed as above moves our own
+    Lookup_Req *req = dynamic_cast<Lookup_Req *> (cmsg);
+    Lookup_Resp *resp = req ? nullptr : dynamic_cast<Lookup_Resp *> (cmsg);
+    if (this->vivaldi_.enabled ()) {
+        if (req && fromPeer) {
+            this->vivaldi_.learn (src, Vivaldi::read (req), req->getCoordError ());
+        } else if (resp) {
+            if (rtt >= SIMTIME_ZERO)
+                this->vivaldi_.sample (src, rtt, Vivaldi::read (resp), resp->getCoordError ());
+            else if (fromPeer)
+                this->vivaldi_.learn (src, Vivaldi::read (resp), resp->getCoordError ());
+            Vivaldi::Coord responder (resp->getResponderCoordArraySize ());
+            for (size_t i = 0; i < responder.size (); ++i)
+                responder[i] = resp->getResponderCoord (i);
+            int host = this->helper_->node_host (strtoll (resp->getSender (), nullptr, 10));
+            if (host >= 0 && host != this->hostIndex_)
+                this->vivaldi_.learn (host, responder, resp->getResponderCoordError ());
+        }
+    }
 
-    // Delete existing socket
-    if (this->socket_)
-        delete this->socket_;
+    if (req) {
+        if (req->getHopID () >= 0)
+            this->ack_hop (req, from);
+        this->serve_lookup (req, from);
+        return;
+    }
 
-    this->socket_ = new_socket;
-    this->socket_->setDataTransferMode (TCP_TRANSFER_OBJECT);
-    this->socket_->setOutputGate (gate ("tcpOut"));
-    this->socket_->setCallbackObject(this, NULL);
-    this->socket_->connect(addr, this->localPort_);
+    Lookup_Ack *ack = dynamic_cast<Lookup_Ack *> (cmsg);
+    if (ack) {
+        this->hop_acked (ack);
+        return;
+    }
+
+    if (resp) {
+        this->relay_resp (resp);
+        return;
+    }
 
-    return this->socket_;
+    Replicate_Msg *rep = dynamic_cast<Replicate_Msg *> (cmsg);
+    if (rep) {
+        this->apply_replica (rep);
+        return;
+    }
+
+    Stabilize_Req *sreq = dynamic_cast<Stabilize_Req *> (cmsg);
+    if (sreq) {
+        this->serve_stabilize (sreq, from);
+        return;
+    }
+
+    // the answer only matters for the traffic it makes; what it tells us
+    // we take from the ring in stabilize
+    if (dynamic_cast<Stabilize_Resp *> (cmsg)) {
+        delete cmsg;
+        return;
+    }
+
+    throw cRuntimeError("ChordNode::handle_chord_msg -- unknown message type %s",
+                        cmsg->getClassName ());
+}
+
+/** handle a message from the UDP layer */
+void ChordNode::udp_arrived (cMessage *msg)
+{
+    // besides data, the UDP layer tells us about ICMP errors, e.g., for a
+    // client that has gone away. The client retransmits if it still cares.
+    if (msg->getKind () != UDP_I_DATA) {
+        CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_UDP_INDICATION, msg->getKind (), 0);
+        delete msg;
+        return;
+    }
+
+    // replies go back to wherever the datagram came from
+    UDPDataIndication *ind = check_and_cast<UDPDataIndication *> (msg->removeControlInfo ());
+    ChordNode::Link from (ind->getSrcAddr (), ind->getSrcPort ());
+    delete ind;
+
+    Chord_Msg *cmsg = dynamic_cast<Chord_Msg *> (msg);
+    if (!cmsg)
+        throw cRuntimeError("ChordNode::udp_arrived -- not a chord message");
+    CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_MSG_ARRIVED, -1, cmsg->getByteLength ());
+    this->handle_chord_msg (cmsg, from);
 }
 
 /** serve the incoming lookup request */
-void ChordNode::serve_lookup (Lookup_Req *req, inet::TCPSocket *socket)
+void ChordNode::serve_lookup (Lookup_Req *req, const ChordNode::Link &from)
 {
-    /* @@@ FILL IN WITH REAL CHORD CODE. @@@ */
-    // You have to handle 2 cases: the key is with you in which case fill up
+    // We have to handle 2 cases: the key is with us in which case fill up
     // the response packet and send back. Or, using the chord algo, send the req
-    // to the next node. Do not forget to preserve the state because now you
-    // become some intermediary who must relay the response back.
-
-    // Make a record who send me request
-    this->callerID = std::atoi(req->getSender());
-    // Convert integer to char array.
-    const char* id  = std::to_string(this->myID_).c_str();
-    // Find key and return response
-    int key = req->getKey();
-    if(key == this->myID_){
-        Lookup_Resp *resp = new Lookup_Resp();
-        resp->setKey(key);
-        resp->setSender(id);
-        // Get responder size, which contains a path of intermediate nodes.
-        int responder_size = resp->getResponderArraySize();
-        resp->setResponderArraySize(responder_size + 1);
-        resp->setResponder(responder_size, id);
-        // Send it back it caller
-        this->connect(this->callerID);
-        this->socket_->send(resp);
-    }
-    // Don't match and pass request to next successor in finger table.
-    else{
-        int m = this->finger_table_size_;
-        for(int i=0; i<m; i++){
-            // Connect and pass request to every node in finger table
-            this->connect((this->ft_ + i)->fingerID);
-            this->socket_->send(req); // Connect socket and relay request.
+    // to the next node and preserve the state because now we become some
+    // intermediary who must relay the response back.
+    simtime_t arrivedAt = simTime ();
+    Helper::NodeID key = req->getKey ();
+
+    // any of our virtual nodes may own the key
+    int owner = this->owning_vnode (key);
+
+    // With replication, a get may be answered by a replica instead: one it
+    // was sent to, the first one on the path that has the key, or, from the
+    // node just before the owner, the one of lowest RTT.
+    Helper::NodeID next = -1;
+    bool replicaRead = false;
+    Get_Req *get = dynamic_cast<Get_Req *> (req);
+    if (owner < 0 && get && this->replicationFactor_ > 0) {
+        int32_t size;
+        if (get->getToReplica ()) {
+            replicaRead = true;
+        } else if (this->replicaRead_ == ChordNode::PATH_READ) {
+            replicaRead = this->is_replica (key) && this->store_->get (key, size);
+        } else if (this->replicaRead_ == ChordNode::CLOSEST_READ) {
+            next = this->next_hop (key, req);
+            Helper::NodeID keyOwner = this->successor (key);
+            if (next == keyOwner) {
+                Helper::IDVector replicas;
+                this->replica_set (keyOwner, replicas);
+                simtime_t bestRtt = this->estimated_rtt (keyOwner);
+                for (Helper::IDVector::iterator it = replicas.begin (); it != replicas.end (); ++it) {
+                    simtime_t rtt = this->estimated_rtt (*it);
+                    if (rtt >= SIMTIME_ZERO && !this->is_suspect (*it) && (bestRtt < SIMTIME_ZERO || rtt < bestRtt)) {
+                        next = *it;
+                        bestRtt = rtt;
+                    }
+                }
+                if (next != keyOwner) {
+                    if (this->is_local (next))
+                        replicaRead = true;
+                    else
+                        get->setToReplica (true);
+                }
+            }
+        }
+    }
+
+    if (owner >= 0 || replicaRead) {
+        string id = (owner >= 0) ? std::to_string (this->vnodes_[owner].id) : std::to_string (this->myID_);
+        // a store operation gets a store answer; a plain lookup does not
+        // touch the store at all
+        bool storeOp = dynamic_cast<Get_Req *> (req) || dynamic_cast<Put_Req *> (req)
+                       || dynamic_cast<Delete_Req *> (req);
+        Lookup_Resp *resp = storeOp ? new KV_Resp () : new Lookup_Resp ();
+        resp->setKey (key);
+        resp->setSender (id.c_str ());
+        resp->setRequester (req->getSender ());
+        resp->setHopCount (req->getHopCount ());
+        resp->setQueuedTime (req->getQueuedTime ());
+        resp->setSeq (req->getSeq ());
+        resp->setEchoTS (req->getHopSentTS ());
+        resp->setReturnPathArraySize (req->getReturnPathArraySize ());
+        for (size_t i = 0; i < req->getReturnPathArraySize (); ++i)
+            resp->setReturnPath (i, req->getReturnPath (i));
+
+        // the responder list holds the path of intermediate nodes; we are the first
+        resp->setResponderArraySize (1);
+        resp->setResponder (0, id.c_str ());
+        resp->setByteLength (req->getByteLength () + 2 * (id.length () + 1));
+        if (this->vivaldi_.enabled ()) {
+            const Vivaldi::Coord &c = this->vivaldi_.coord ();
+            resp->setResponderCoordArraySize (c.size ());
+            for (size_t i = 0; i < c.size (); ++i)
+                resp->setResponderCoord (i, c[i]);
+            resp->setResponderCoordError (this->vivaldi_.error ());
+            resp->addByteLength ((c.size () + 1) * sizeof (double));
+        }
+
+        CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_LOOKUP_OWNED, key,
+                     (owner >= 0) ? this->vnodes_[owner].id : this->myID_);
+
+        simtime_t service = SIMTIME_ZERO;
+        if (storeOp) {
+            KV_Resp *kv = check_and_cast<KV_Resp *> (resp);
+            kv->setReplica (replicaRead);
+            service = this->apply_store_op (req, kv);
+            if (replicaRead) {
+                this->replicaGets_++;
+            } else if (this->replicationFactor_ > 0 && kv->getOp () != KV_GET) {
+                this->replicate (this->vnodes_[owner].id, key, kv->getOp (),
+                                 (kv->getOp () == KV_PUT) ? check_and_cast<Put_Req *> (req)->getValueSize () : 0);
+            }
         }
+        delete req;
+        if (!replicaRead)
+            this->load_->requestsOwned++;
+
+        // send it back on the connection the request came in on, after the
+        // store is done with it
+        if (storeOp) {
+            this->queue_store_job (from, resp, arrivedAt, service);
+        } else {
+            this->echo (resp, resp->getEchoTS (), arrivedAt);
+            this->send_msg (from, resp, arrivedAt);
+        }
+        return;
     }
- }
+
+    // Don't own the key; pass request to the next node chosen from the
+    // routing table (unless we picked a replica above).
+    if (next < 0)
+        next = this->next_hop (key, req);
+
+    CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_LOOKUP_FORWARDED, key, next);
+
+    // Make a record of who sent us the request so that we can relay the
+    // response, and forget those that have waited too long for theirs
+    while (!this->callerMap_.empty ()
+           && this->callerMap_.begin ()->second.arrivedAt + this->callerLifetime_ < arrivedAt)
+        this->callerMap_.erase (this->callerMap_.begin ());
+    int64_t callerID = this->nextCallerID_++;
+    ChordNode::Caller &caller = this->callerMap_[callerID];
+    caller.link = from;
+    caller.echoTS = req->getHopSentTS ();
+    caller.arrivedAt = arrivedAt;
+    size_t depth = req->getReturnPathArraySize ();
+    req->setReturnPathArraySize (depth + 1);
+    req->setReturnPath (depth, callerID);
+    req->addByteLength (sizeof (int64_t));
+
+    req->setHopCount (req->getHopCount () + 1);
+    this->load_->requestsForwarded++;
+    if (this->failureDetector_)
+        this->watch_hop (req, next, 0, arrivedAt);
+    else
+        this->send_msg (this->node_link (next), req, arrivedAt);
+}
 
 /** relay the response up the chain */
 void ChordNode::relay_resp (Lookup_Resp *resp)
 {
-    /* @@@ FILL IN  @@@ */
     // Recall that we may be an intermediate chord node who is receiving reply
     // from a downstream chord node, and must relay is to whoever called us.
-    // To do that, we must retrieve the connection state we had saved corresponding to
+    // To do that, we retrieve the connection state we had saved corresponding to
     // this chain of request/reply, and use that to send the response upstream.
-    // Do not forget to include ourselves in the chain.
+    simtime_t arrivedAt = simTime ();
+    size_t depth = resp->getReturnPathArraySize ();
+    CallerMap::iterator it = (depth > 0) ? this->callerMap_.find (resp->getReturnPath (depth - 1))
+                                         : this->callerMap_.end ();
+    if (it == this->callerMap_.end ()) {
+        CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_RESP_DROPPED, resp->getKey (), 0);
+        delete resp;
+        return;
+    }
+    ChordNode::Caller caller = it->second;
+    this->callerMap_.erase (it);
+    resp->setReturnPathArraySize (depth - 1);
+    resp->addByteLength (- (int64_t) sizeof (int64_t));
+
+    // include ourselves in the chain
+    string id = std::to_string (this->myID_);
+    int responder_size = resp->getResponderArraySize ();
+    resp->setResponderArraySize (responder_size + 1);
+    resp->setResponder (responder_size, id.c_str ());
+    resp->addByteLength (id.length () + 1);
+
+    this->echo (resp, caller.echoTS, caller.arrivedAt);
+    this->send_msg (caller.link, resp, arrivedAt);
+}
 
-    const char* id  = std::to_string(this->myID_).c_str();
-    int responder_size = resp->getResponderArraySize();
-    resp->setResponderArraySize(responder_size + 1);
-    resp->setResponder(responder_size, id);
+/** make a message an answer */
+void ChordNode::echo (Chord_Msg *msg, simtime_t echoTS, simtime_t arrivedAt)
+{
+    msg->setEchoTS (echoTS);
+    msg->setEchoHeld (simTime () - arrivedAt);
+}
+
+/** apply a store operation and fill in its answer */
+simtime_t ChordNode::apply_store_op (Lookup_Req *req, KV_Resp *resp)
+{
+    // the value only travels with a put and with the answer to a get that
+    // found one; the answer also carries the op, found and size fields
+    KVStore::Key key = req->getKey ();
+    simtime_t service;
+    Put_Req *put = dynamic_cast<Put_Req *> (req);
+    if (put) {
+        resp->setOp (KV_PUT);
+        resp->setFound (this->store_->put (key, put->getValueSize ()));
+        resp->addByteLength (- (int64_t) put->getValueSize ());
+        this->kvPuts_++;
+        service = this->par ("putServiceTime").doubleValue ();
+    } else if (dynamic_cast<Delete_Req *> (req)) {
+        resp->setOp (KV_DELETE);
+        resp->setFound (this->store_->remove (key));
+        this->kvDeletes_++;
+        service = this->par ("deleteServiceTime").doubleValue ();
+    } else {
+        int32_t size = 0;
+        resp->setOp (KV_GET);
+        resp->setFound (this->store_->get (key, size));
+        resp->setValueSize (size);
+        resp->addByteLength (size);
+        this->kvGets_++;
+        if (resp->getFound ())
+            this->kvGetHits_++;
+        service = this->par ("getServiceTime").doubleValue ();
+    }
+    resp->addByteLength (2 * sizeof (int) + 1);
+
+    if (this->store_->bytes () > this->peakStoreBytes_)
+        this->peakStoreBytes_ = this->store_->bytes ();
 
-    // Connect to caller socket and send response
-    this->connect(this->callerID);
-    this->socket_->send(resp);
+    CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_STORE_OP, key,
+                 2 * resp->getOp () + (resp->getFound () ? 1 : 0));
+    return service;
+}
+
+/** the nodes holding a replica of the keys of the given owner */
+void ChordNode::replica_set (Helper::NodeID owner, Helper::IDVector &replicas)
+{
+    // walk the ring from the owner on, taking one node per host not seen
+    // yet; with virtual nodes the next few IDs are often on the same host,
+    // which would not make for a copy that survives the host
+    set<int> hosts;
+    hosts.insert (this->helper_->node_host (owner));
+    size_t n = this->nodeList_->size ();
+    size_t pos = std::lower_bound (this->nodeList_->begin (), this->nodeList_->end (), owner)
+                 - this->nodeList_->begin ();
+    for (size_t k = 1; k < n && (int) replicas.size () < this->replicationFactor_; ++k) {
+        Helper::NodeID id = (*this->nodeList_)[(pos + k) % n];
+        if (hosts.insert (this->helper_->node_host (id)).second)
+            replicas.push_back (id);
+    }
+}
+
+/** do we hold a replica of the key */
+bool ChordNode::is_replica (Helper::NodeID key)
+{
+    Helper::IDVector replicas;
+    this->replica_set (this->successor (key), replicas);
+    for (Helper::IDVector::iterator it = replicas.begin (); it != replicas.end (); ++it) {
+        if (this->is_local (*it))
+            return true;
+    }
+    return false;
+}
+
+/** pass a put or delete on to the replicas of the key */
+void ChordNode::replicate (Helper::NodeID owner, KVStore::Key key, int op, int valueSize)
+{
+    Helper::IDVector replicas;
+    this->replica_set (owner, replicas);
+    for (Helper::IDVector::iterator it = replicas.begin (); it != replicas.end (); ++it) {
+        Replicate_Msg *msg = new Replicate_Msg ();
+        msg->setKey (key);
+        msg->setOp (op);
+        msg->setValueSize (valueSize);
+        msg->setHopCount (0);
+        msg->setQueuedTime (SIMTIME_ZERO);
+        msg->setByteLength (sizeof (int64_t) + 2 * sizeof (int) + ((op == KV_PUT) ? valueSize : 0));
+        this->send_msg (this->node_link (*it), msg, simTime ());
+    }
+}
+
+/** apply a put or delete passed on by the owner */
+void ChordNode::apply_replica (Replicate_Msg *msg)
+{
+    // nobody waits for the answer, but the store is busy for the service
+    // time all the same
+    simtime_t service;
+    if (msg->getOp () == KV_PUT) {
+        this->store_->put (msg->getKey (), msg->getValueSize ());
+        service = this->par ("putServiceTime").doubleValue ();
+    } else {
+        this->store_->remove (msg->getKey ());
+        service = this->par ("deleteServiceTime").doubleValue ();
+    }
+    simtime_t start = (this->storeBusyUntil_ > simTime ()) ? this->storeBusyUntil_ : simTime ();
+    this->storeBusyUntil_ = start + service;
+    this->replicaUpdates_++;
+    if (this->store_->bytes () > this->peakStoreBytes_)
+        this->peakStoreBytes_ = this->store_->bytes ();
+
+    CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_REPLICA_APPLIED, msg->getKey (), msg->getOp ());
+    delete msg;
+}
+
+/** send the answer to a store operation once the store is done with it */
+void ChordNode::queue_store_job (const ChordNode::Link &to, Lookup_Resp *resp, simtime_t arrivedAt, simtime_t service)
+{
+    // the store works through the operations one at a time
+    simtime_t start = (this->storeBusyUntil_ > simTime ()) ? this->storeBusyUntil_ : simTime ();
+    this->storeBusyUntil_ = start + service;
+
+    ChordNode::StoreJob job;
+    job.resp = resp;
+    job.to = to;
+    job.arrivedAt = arrivedAt;
+    job.doneAt = this->storeBusyUntil_;
+    this->storeJobs_.push_back (job);
+
+    if (!this->storeTimer_->isScheduled ())
+        this->scheduleAt (this->storeJobs_.front ().doneAt, this->storeTimer_);
+}
+
+/** send the answers of the store operations that are done */
+void ChordNode::store_timer (void)
+{
+    while (!this->storeJobs_.empty () && this->storeJobs_.front ().doneAt <= simTime ()) {
+        ChordNode::StoreJob job = this->storeJobs_.front ();
+        this->storeJobs_.pop_front ();
+        this->emit (ChordNode::storeTimeSignal, simTime () - job.arrivedAt);
+        this->echo (job.resp, job.resp->getEchoTS (), job.arrivedAt);
+        this->send_msg (job.to, job.resp, job.arrivedAt);
+    }
+    if (!this->storeJobs_.empty ())
+        this->scheduleAt (this->storeJobs_.front ().doneAt, this->storeTimer_);
+}
+
+/** hand a message to the transport, or hold it until the connection is up */
+void ChordNode::send_msg (const ChordNode::Link &link, Chord_Msg *msg, simtime_t arrivedAt)
+{
+    if (link.socket && link.socket->getState () != TCPSocket::CONNECTED) {
+        // the connection is still being set up. Keep the message with us so
+        // that the wait shows up as queueing time at this node.
+        ChordNode::PendingMsg pm;
+        pm.msg = msg;
+        pm.arrivedAt = arrivedAt;
+        this->pendingMap_[link.socket].push_back (pm);
+        return;
+    }
+
+    simtime_t queued = simTime () - arrivedAt;
+    this->emit (ChordNode::queueTimeSignal, queued);
+    this->start_hop_timer (msg, false);
+
+    msg->setQueuedTime (msg->getQueuedTime () + queued);
+    msg->setHopSentTS (simTime ());
+    this->load_->bytesOut += msg->getByteLength ();
+    this->load_->messagesOut++;
+
+    // tell the receiver who we are; chord hosts have the overlay address of
+    // their index, whatever the transport
+    msg->setSrcAddress (this->hostIndex_);
+
+    // and where we are, on lookups and their answers
+    if (this->vivaldi_.enabled ()) {
+        Lookup_Req *req = dynamic_cast<Lookup_Req *> (msg);
+        Lookup_Resp *resp = req ? nullptr : dynamic_cast<Lookup_Resp *> (msg);
+        int size = (this->vivaldi_.coord ().size () + 1) * sizeof (double);
+        if (req) {
+            if (req->getCoordArraySize () == 0)
+                req->addByteLength (size);
+            this->vivaldi_.stamp (req);
+        } else if (resp) {
+            if (resp->getCoordArraySize () == 0)
+                resp->addByteLength (size);
+            this->vivaldi_.stamp (resp);
+        }
+    }
+
+    if (link.socket) {
+        link.socket->send (msg);
+    } else if (this->transport_ == Helper::UDP) {
+        this->udpSocket_.sendTo (msg, link.addr, link.port);
+    } else {
+        // overlay transport: no stack in between, just the modelled delay
+        simtime_t delay = this->latency_->delay (this->hostIndex_, link.address, msg->getByteLength ());
+        this->gateway_->deliver (msg, link.address, delay);
+    }
+}
+
+/** send everything that was waiting for this socket to get connected */
+void ChordNode::flush_pending (inet::TCPSocket *socket)
+{
+    PendingMap::iterator it = this->pendingMap_.find (socket);
+    if (it == this->pendingMap_.end ())
+        return;
+
+    PendingQueue queue;
+    queue.swap (it->second);
+    this->pendingMap_.erase (it);
+
+    for (PendingQueue::iterator pit = queue.begin (); pit != queue.end (); ++pit)
+        this->send_msg (ChordNode::Link (socket), pit->msg, pit->arrivedAt);
+}
+
+/** forget all state that refers to a socket which is going away */
+void ChordNode::forget_socket (inet::TCPSocket *socket)
+{
+    // a failed connect makes room for a waiting one
+    if (this->connectStartedAt_.erase (socket->getConnectionId ()) > 0)
+        this->next_connect ();
+    for (DeferredConnectQueue::iterator it = this->deferredConnects_.begin (); it != this->deferredConnects_.end (); ) {
+        if (it->socket == socket)
+            it = this->deferredConnects_.erase (it);
+        else
+            ++it;
+    }
+
+    PendingMap::iterator pit = this->pendingMap_.find (socket);
+    if (pit != this->pendingMap_.end ()) {
+        for (PendingQueue::iterator qit = pit->second.begin (); qit != pit->second.end (); ++qit) {
+            this->start_hop_timer (qit->msg, true);
+            delete qit->msg;
+        }
+        this->pendingMap_.erase (pit);
+    }
+
+    for (CallerMap::iterator it = this->callerMap_.begin (); it != this->callerMap_.end (); ) {
+        if (it->second.link.socket == socket)
+            this->callerMap_.erase (it++);
+        else
+            ++it;
+    }
+
+    // answers of the store that would go out on it
+    for (StoreJobQueue::iterator it = this->storeJobs_.begin (); it != this->storeJobs_.end (); ) {
+        if (it->to.socket == socket) {
+            delete it->resp;
+            it = this->storeJobs_.erase (it);
+        } else {
+            ++it;
+        }
+    }
+
+    // peers on this socket reconnect the next time they are used
+    for (ConnectionPool::iterator it = this->connPool_.begin (); it != this->connPool_.end (); ) {
+        if (it->second == socket)
+            this->connPool_.erase (it++);
+        else
+            ++it;
+    }
+
+    if (this->socket_ == socket)
+        this->socket_ = nullptr;
+}
+
+/** refresh the open socket count in our load counters */
+void ChordNode::update_socket_count (void)
+{
+    this->load_->openSockets = this->socketMap_.size ();
+    if (this->load_->openSockets > this->load_->peakSockets)
+        this->load_->peakSockets = this->load_->openSockets;
 }
 
 // find the successor node
-int ChordNode::successor (int id)
+Helper::NodeID ChordNode::successor (Helper::NodeID id)
 {
-    /* @@@ FILL IN  @@@ */
+    // id is the key whose successor is to be found. We search in the (sorted)
+    // nodeList_. successor is that immediate node which is given by the condition
+    // id <= node. If we reach the end, then the first node in the list is the
+    // successor because we wrap around.
+    if (this->nodeList_->empty ())
+        throw cRuntimeError("ChordNode::successor -- no host is on the ring");
+    Helper::IDVector::const_iterator it
+        = std::lower_bound (this->nodeList_->begin (), this->nodeList_->end (), id);
+    return (it == this->nodeList_->end ()) ? this->nodeList_->front () : *it;
+}
+
+/** the predecessors and successors of our virtual nodes on the ring */
+void ChordNode::update_neighbours (void)
+{
+    for (VirtualNodeVector::iterator it = this->vnodes_.begin (); it != this->vnodes_.end (); ++it) {
+        // the predecessor on the ring tells us which keys the virtual node owns
+        Helper::IDVector::const_iterator pos
+            = std::lower_bound (this->nodeList_->begin (), this->nodeList_->end (), it->id);
+        it->predecessorID
+            = (pos == this->nodeList_->begin ()) ? this->nodeList_->back () : *(pos - 1);
+
+        // and the successors who own the keys just past it, should the
+        // first ones fail
+        size_t n = this->nodeList_->size ();
+        size_t first = pos - this->nodeList_->begin ();
+        it->successors.clear ();
+        for (size_t k = 1; k < n && (int) it->successors.size () < this->successorListSize_; ++k)
+            it->successors.push_back ((*this->nodeList_)[(first + k) % n]);
+        it->successorID = it->successors.empty () ? it->id : it->successors.front ();
+    }
+}
+
+/** one stabilization round */
+void ChordNode::stabilize (void)
+{
+    // Nodes may have left the ring or come back since the last round. Chord
+    // finds out through its stabilize and fix-fingers rounds; we send the
+    // messages of a stabilize round, a check of the successor we knew for
+    // every virtual node, and take the outcome, our neighbours and a routing
+    // table as the rounds would settle them, from the ring the helper keeps.
+    // Until then lookups may go to nodes that are gone.
+    Helper::IDVector ids;
+    for (VirtualNodeVector::iterator it = this->vnodes_.begin (); it != this->vnodes_.end (); ++it) {
+        ids.push_back (it->id);
+        if (this->is_local (it->successorID))
+            continue;
+        Stabilize_Req *req = new Stabilize_Req ();
+        req->setNodeID (it->id);
+        req->setHopCount (0);
+        req->setQueuedTime (SIMTIME_ZERO);
+        req->setByteLength (sizeof (int64_t) + 2 * sizeof (int));
+        this->send_maintenance (this->node_link (it->successorID), req);
+    }
 
-    // id is the key whose successor is to be found. We search in the nodeList_.
-    // successor is that immediate node which is given by the condition
-    // id <= node. So we start checking from the beginning. If we reach the end, then
-    // the first node in the list is the successor because we wrap around.
+    this->update_neighbours ();
+    this->routing_->build (ids);
+
+    if (this->stabilizeInterval_ > SIMTIME_ZERO && !this->stabilizeTimer_->isScheduled ())
+        this->scheduleAt (simTime () + this->stabilizeInterval_, this->stabilizeTimer_);
+}
+
+/** answer a successor check */
+void ChordNode::serve_stabilize (Stabilize_Req *req, const ChordNode::Link &from)
+{
+    // the asking node's successor is whichever of our virtual nodes owns
+    // the ID just past it, if any still does
+    Helper::NodeID after = (req->getNodeID () + 1) % this->helper_->key_space ();
+    int v = this->owning_vnode (after);
+
+    Stabilize_Resp *resp = new Stabilize_Resp ();
+    resp->setNodeID (req->getNodeID ());
+    resp->setPredecessor ((v >= 0) ? this->vnodes_[v].predecessorID : -1);
+    resp->setHopCount (0);
+    resp->setQueuedTime (SIMTIME_ZERO);
+    resp->setByteLength (2 * sizeof (int64_t) + 2 * sizeof (int));
+    this->echo (resp, req->getHopSentTS (), simTime ());
+    delete req;
+    this->send_maintenance (from, resp);
+}
+
+/** send a stabilization or key hand-over message */
+void ChordNode::send_maintenance (const ChordNode::Link &link, Chord_Msg *msg)
+{
+    this->maintenanceMsgs_++;
+    this->maintenanceBytes_ += msg->getByteLength ();
+    this->emit (ChordNode::maintenanceBytesSignal, (long) msg->getByteLength ());
+    this->send_msg (link, msg, simTime ());
+}
+
+/** our host has been taken off the ring */
+void ChordNode::leave (bool graceful)
+{
+    if (this->transport_ == Helper::TCP)
+        throw cRuntimeError ("ChordNode::leave -- churn needs the overlay or the UDP transport");
+    if (!this->up_)
+        return;
+
+    EV << "=== ChordNode::leave NodeID: " << this->myID_
+       << (graceful ? " leaving" : " crashing") << ", "
+       << this->store_->size () << " keys stored" << endl;
+
+    // Leaving gracefully, we pass every key we hold on to its owner on the
+    // ring without us, as if the owner replicated a put to it. After a
+    // crash the keys are gone, short of replicas elsewhere.
+    vector<KVStore::Entry> entries;
+    this->store_->entries (entries);
+    for (vector<KVStore::Entry>::iterator it = entries.begin (); it != entries.end (); ++it) {
+        if (graceful) {
+            Replicate_Msg *msg = new Replicate_Msg ();
+            msg->setKey (it->first);
+            msg->setOp (KV_PUT);
+            msg->setValueSize (it->second);
+            msg->setHopCount (0);
+            msg->setQueuedTime (SIMTIME_ZERO);
+            msg->setByteLength (sizeof (int64_t) + 2 * sizeof (int) + it->second);
+            this->send_maintenance (this->node_link (this->successor (it->first)), msg);
+        }
+        this->store_->remove (it->first);
+    }
+
+    // whatever we were in the middle of is lost
+    for (StoreJobQueue::iterator it = this->storeJobs_.begin (); it != this->storeJobs_.end (); ++it)
+        delete it->resp;
+    this->storeJobs_.clear ();
+    this->storeBusyUntil_ = simTime ();
+    cancelEvent (this->storeTimer_);
+    cancelEvent (this->stabilizeTimer_);
+    this->callerMap_.clear ();
+    this->forget_watched_hops ();
+    this->suspects_.clear ();
+
+    this->up_ = false;
+    setStatusString ("down");
+}
 
-    // Sort node list in accending order
-    std::sort(this->nodeList_.begin(), this->nodeList_.end(), [](int a, int b) {
-        return (a < b);
-    });
-    for(int i=0; i<this->nodeList_.size(); i++){
-        int value = this->nodeList_.at(i);
-        if(id <= value) return value;
+/** our host is back on the ring */
+void ChordNode::join (void)
+{
+    if (this->up_)
+        return;
+
+    EV << "=== ChordNode::join NodeID: " << this->myID_ << " back on the ring" << endl;
+
+    // We come back with the IDs we had and an empty store; the keys we own
+    // again stay with the node that took them over until they are put anew.
+    // A stabilization round right away gets us our neighbours and routing
+    // table.
+    this->up_ = true;
+    this->stabilize ();
+    setStatusString ("up");
+}
+
+/** round-trip time we expect to the host running the given node */
+simtime_t ChordNode::estimated_rtt (Helper::NodeID nodeID)
+{
+    int host = this->helper_->node_host (nodeID);
+    if (host < 0)
+        return simtime_t (-1);
+    if (host == this->hostIndex_)
+        return SIMTIME_ZERO;
+
+    // what we measured beats any estimate
+    if (this->rtt_.has (host))
+        return this->rtt_.srtt (host);
+
+    // with coordinates we go by what they predict and by nothing we could
+    // not know in a real deployment
+    if (this->vivaldi_.enabled ())
+        return this->vivaldi_.predict (host);
+
+    // the overlay transport has a model of the delays; otherwise we go by
+    // the propagation delays along the path through the network
+    if (this->transport_ == Helper::OVERLAY)
+        return this->latency_->base_delay (this->hostIndex_, host) * 2;
+    double d = this->helper_->path_delay (host, this->hostIndex_);
+    return (d < 0.0) ? simtime_t (-1) : simtime_t (d * 2);
+}
+
+/** the RTT our coordinates predict to the host of the given node */
+simtime_t ChordNode::predicted_rtt (Helper::NodeID nodeID)
+{
+    int host = this->helper_->node_host (nodeID);
+    if (host < 0)
+        return simtime_t (-1);
+    if (host == this->hostIndex_)
+        return SIMTIME_ZERO;
+    return this->vivaldi_.predict (host);
+}
+
+/** index of our virtual node owning the key, or -1 if none of them does */
+int ChordNode::owning_vnode (Helper::NodeID key)
+{
+    for (size_t v = 0; v < this->vnodes_.size (); ++v) {
+        if (Helper::in_interval (key, this->vnodes_[v].predecessorID, this->vnodes_[v].id, true))
+            return v;
+    }
+    return -1;
+}
+
+/** is the given ID one of our virtual nodes */
+bool ChordNode::is_local (Helper::NodeID nodeID)
+{
+    for (VirtualNodeVector::iterator it = this->vnodes_.begin (); it != this->vnodes_.end (); ++it) {
+        if (it->id == nodeID)
+            return true;
+    }
+    return false;
+}
+
+/** the successor table the helper keeps for all the nodes */
+const Helper::IntVector *ChordNode::successor_table (const Helper::IDVector &offsets)
+{
+    return &this->helper_->successor_table (offsets);
+}
+
+/** mean of the RTTs we measured */
+simtime_t ChordNode::mean_rtt (void)
+{
+    return this->rtt_.mean ();
+}
+
+/** ID of the node to which a lookup for key is forwarded */
+Helper::NodeID ChordNode::next_hop (Helper::NodeID key, Lookup_Req *req)
+{
+    // We route on behalf of all our virtual nodes at once. If the key lies
+    // between one of them and its successor, that successor owns it;
+    // otherwise the routing table gets the lookup closer.
+    //
+    // A successor we suspect has likely left the ring. The keys of the
+    // successors after it on our list go straight to them, since no other
+    // node is closer to those keys than the suspect; its own keys go to the
+    // next one we do not suspect, which takes them over.
+    for (VirtualNodeVector::iterator vit = this->vnodes_.begin (); vit != this->vnodes_.end (); ++vit) {
+        Helper::NodeID from = vit->id;
+        for (Helper::IDVector::iterator sit = vit->successors.begin (); sit != vit->successors.end (); ++sit) {
+            if (Helper::in_interval (key, from, *sit, true)) {
+                for (; sit != vit->successors.end (); ++sit) {
+                    if (!this->is_suspect (*sit))
+                        return *sit;
+                }
+                return vit->successorID;
+            }
+            if (!this->is_suspect (*sit))
+                break;
+            from = *sit;
+        }
+    }
+    return this->routing_->next_hop (key, req);
+}
+
+/** do we suspect the host of the given node of having failed */
+bool ChordNode::is_suspect (Helper::NodeID nodeID)
+{
+    if (this->suspects_.empty ())
+        return false;
+    map<int, simtime_t>::iterator it = this->suspects_.find (this->helper_->node_host (nodeID));
+    if (it == this->suspects_.end ())
+        return false;
+
+    // suspicion runs out: the host may be back by now
+    if (it->second <= simTime ()) {
+        this->suspects_.erase (it);
+        return false;
+    }
+    return true;
+}
+
+/** how long we wait for the ack of a lookup forwarded to the given node */
+simtime_t ChordNode::ack_timeout (Helper::NodeID nodeID)
+{
+    // Jacobson's RTO from our estimate for the host. Until we have one we
+    // wait as long as TCP would for its first segment.
+    int host = this->helper_->node_host (nodeID);
+    simtime_t rto = this->suspectInitialTimeout_;
+    if (this->rtt_.has (host))
+        rto = this->rtt_.srtt (host) + this->rtt_.rttvar (host) * 4;
+    return (rto < this->suspectMinTimeout_) ? this->suspectMinTimeout_ : rto;
+}
+
+/** send the lookup to the given node and wait for its ack */
+void ChordNode::watch_hop (Lookup_Req *req, Helper::NodeID next, int reroutes, simtime_t arrivedAt)
+{
+    int64_t hopID = this->nextHopID_++;
+    req->setHopID (hopID);
+
+    // the timer is started by send_msg: the lookup may have to wait here
+    // for its connection first
+    ChordNode::WatchedHop wh;
+    wh.req = req->dup ();
+    wh.next = next;
+    wh.reroutes = reroutes;
+    wh.timer = new cMessage ("hop_timeout", 5);
+    wh.timer->setContextPointer ((void *) (intptr_t) hopID);
+    this->watchedHops_[hopID] = wh;
+    this->hopsWatched_++;
+
+    this->send_msg (this->node_link (next), req, arrivedAt);
+}
+
+/** start the ack timer of a watched lookup that leaves us, or is lost */
+void ChordNode::start_hop_timer (Chord_Msg *msg, bool lost)
+{
+    if (this->watchedHops_.empty ())
+        return;
+    Lookup_Req *req = dynamic_cast<Lookup_Req *> (msg);
+    if (!req || req->getHopID () < 0)
+        return;
+    WatchedHopMap::iterator it = this->watchedHops_.find (req->getHopID ());
+    if (it == this->watchedHops_.end () || it->second.timer->isScheduled ())
+        return;
+
+    // a lookup that never made it out times out right away
+    simtime_t timeout = lost ? SIMTIME_ZERO : this->ack_timeout (it->second.next);
+    this->scheduleAt (simTime () + timeout, it->second.timer);
+}
+
+/** acknowledge a lookup to the node that forwarded it to us */
+void ChordNode::ack_hop (Lookup_Req *req, const ChordNode::Link &from)
+{
+    Lookup_Ack *ack = new Lookup_Ack ();
+    ack->setHopID (req->getHopID ());
+    ack->setHopCount (0);
+    ack->setQueuedTime (SIMTIME_ZERO);
+    ack->setByteLength (sizeof (int64_t) + 2 * sizeof (int));
+    this->echo (ack, req->getHopSentTS (), simTime ());
+    this->hopAcks_++;
+    this->send_msg (from, ack, simTime ());
+
+    // should we pass the lookup on, the next hop acks to us only if we ask
+    req->setHopID (-1);
+}
+
+/** the next hop has acknowledged a lookup */
+void ChordNode::hop_acked (Lookup_Ack *ack)
+{
+    // an ack that comes after we gave up on it finds nothing to stop
+    WatchedHopMap::iterator it = this->watchedHops_.find (ack->getHopID ());
+    if (it != this->watchedHops_.end ()) {
+        cancelAndDelete (it->second.timer);
+        delete it->second.req;
+        this->watchedHops_.erase (it);
+    }
+    delete ack;
+}
+
+/** the ack of a forwarded lookup is overdue */
+void ChordNode::hop_timeout (cMessage *timer)
+{
+    int64_t hopID = (int64_t) (intptr_t) timer->getContextPointer ();
+    delete timer;
+    WatchedHopMap::iterator it = this->watchedHops_.find (hopID);
+    if (it == this->watchedHops_.end ())
+        return;
+    ChordNode::WatchedHop wh = it->second;
+    this->watchedHops_.erase (it);
+
+    Lookup_Req *req = wh.req;
+    int host = this->helper_->node_host (wh.next);
+    if (this->suspects_.find (host) == this->suspects_.end ()) {
+        this->suspicions_++;
+        this->emit (ChordNode::peerSuspectedSignal, (long) wh.next);
+    }
+    this->suspects_[host] = simTime () + this->suspectPeriod_;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_PEER_SUSPECTED, wh.next, req->getKey ());
+
+    // Send the lookup another way, towards the owner even if it was on its
+    // way to a replica. The Koorde state the lookup carries was meant for
+    // the suspect, so a Koorde lookup starts over from here. If all the
+    // routing table has is another suspect, the client's retransmission is
+    // left to get the lookup through.
+    req->setRouteImaginary (-1);
+    Get_Req *get = dynamic_cast<Get_Req *> (req);
+    if (get)
+        get->setToReplica (false);
+    Helper::NodeID next = (wh.reroutes < this->maxReroutes_) ? this->next_hop (req->getKey (), req) : -1;
+    if (next < 0 || this->is_suspect (next)) {
+        this->reroutesAbandoned_++;
+        delete req;
+        return;
+    }
+
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_LOOKUP_REROUTED, req->getKey (), next);
+    this->reroutes_++;
+    this->watch_hop (req, next, wh.reroutes + 1, simTime ());
+}
+
+/** stop waiting for any acks */
+void ChordNode::forget_watched_hops (void)
+{
+    for (WatchedHopMap::iterator it = this->watchedHops_.begin (); it != this->watchedHops_.end (); ++it) {
+        cancelAndDelete (it->second.timer);
+        delete it->second.req;
     }
-    return this->nodeList_.at(0);
+    this->watchedHops_.clear ();
 }
 
 void ChordNode::setStatusString(const char *s)
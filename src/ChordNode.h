@@ -14,42 +14,123 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <stack>
+#include <set>
+#include <deque>
 using namespace std;
 
 #include "inet/common/INETDefs.h"  // this contains imp definitions from the INET
 #include "inet/transportlayer/contract/tcp/TCPSocket.h" // this is needed for sockets
 #include "inet/transportlayer/contract/tcp/TCPSocketMap.h"  // this is needed to maintain multiple connected sockets from other peers
+#include "inet/transportlayer/contract/udp/UDPSocket.h"     // datagrams for the UDP transport
 
+#include "ChordP2PMsg_m.h"  // our message types
 #include "Helper.h" // helper functions
+#include "LatencyModel.h" // delays of the overlay transport
+#include "OverlayGateway.h" // delivery of the overlay transport
+#include "RttEstimator.h" // measured RTTs to our peers
+#include "Vivaldi.h" // predicted RTTs to our peers
+#include "KVStore.h" // our share of the stored data
+#include "RoutingTable.h" // how lookups get closer to the key
+#include "RingSnapshot.h" // saved ring state
+#include "Trace.h" // binary trace points
 
 class ChordNode : public cSimpleModule,
-                  public inet::TCPSocket::CallbackInterface
+                  public inet::TCPSocket::CallbackInterface,
+                  public RoutingTable::Owner
 {
   public:
-    //* @@@ FILL IN @@@ */
-    // data structure for the finger table
-    // I am maintaining this mapping but if you feel you need more details, please
-    // modify the data structure
-    struct Fingertable {
-        int fingerID;               // id of the i_th finger
-        inet::TCPSocket    *socket; // socket connection to that finger
+    // which copy of a key a get is served from when keys are replicated
+    enum ReplicaRead {
+        OWNER_READ,     // always the owner
+        PATH_READ,      // the first node on the lookup path holding a replica
+        CLOSEST_READ    // the node before the owner sends it to the replica of lowest RTT
+    };
+
+    // Where a message goes: a TCP connection, the IP address and port of a
+    // UDP peer or, with the overlay transport, the overlay address of the
+    // endpoint it is handed to directly.
+    struct Link {
+        inet::TCPSocket *socket;    // the connection (TCP transport)
+        int address;                // the receiving endpoint (overlay transport)
+        inet::L3Address addr;       // the peer (UDP transport)
+        int port;                   // and its port
+
+        Link (inet::TCPSocket *s = nullptr, int a = -1) : socket (s), address (a), addr (), port (-1) {}
+        Link (const inet::L3Address &ad, int p) : socket (nullptr), address (-1), addr (ad), port (p) {}
     };
 
-    //* @@@ FILL IN @@@ */
-    // You need a data structure declaration here: The purpose is mentioned below in the
-    // comments
-    //
     // The following data structure is going to be used to preserve the calling socket.
     // This is needed for the case when we cannot find the key with ourselves and so must
     // pass it on to the next node using the chord algo. When the reply gets relayed back,
     // we will need to preserve the state, i.e., the socket, so that we can relay the
     // response upstream using the saved socket pointer.
     //
-    // Our assumption here is that the client is not multithreaded and hence can
-    // participate in only one lookup at a time.
+    // A lookup may pass the same host more than once (Koorde with virtual
+    // nodes does), so the state is kept per hop: each node that passes a
+    // request on pushes the ID of its entry onto the request's return path,
+    // and pops it off the response on the way back. Entries whose response
+    // never comes are dropped after callerLifetime_.
+    //
+    // The response echoes the timestamp the caller put on the request, and
+    // how long we held the request, so that the caller can time the round
+    // trip to us.
+    struct Caller {
+        Link link;              // where the response goes
+        simtime_t echoTS;       // hopSentTS of the request
+        simtime_t arrivedAt;    // when the request reached us
+    };
+    typedef map<int64_t, Caller> CallerMap;    // by caller ID, i.e., in the order made
 
-    // Hint: I think you will need to keep some map indexed by the sender id
+    // a message waiting inside this node for its outgoing connection to be
+    // established, along with the time it arrived here
+    struct PendingMsg {
+        Chord_Msg *msg;
+        simtime_t arrivedAt;
+    };
+    typedef deque<PendingMsg> PendingQueue;
+    typedef map<inet::TCPSocket *, PendingQueue> PendingMap;
+
+    // the answer to a store operation, held back for its service time. The
+    // store serves one operation at a time in arrival order.
+    struct StoreJob {
+        Lookup_Resp *resp;      // the answer
+        Link to;                // where it goes
+        simtime_t arrivedAt;    // when the request reached us
+        simtime_t doneAt;       // when the store is done with it
+    };
+    typedef deque<StoreJob> StoreJobQueue;
+
+    // one of the virtual nodes we run. Each has its own ID on the ring; all
+    // of them share our routing table, our listening socket and our
+    // connections to other hosts.
+    struct VirtualNode {
+        Helper::NodeID id;              // ring ID of this virtual node
+        Helper::NodeID predecessorID;   // ID of the node preceding it on the ring
+        Helper::NodeID successorID;     // ID of the node following it on the ring
+        Helper::IDVector successors;    // and the ones after that, as of the last
+                                        // stabilization (successorListSize_ in all)
+    };
+    typedef vector<VirtualNode> VirtualNodeVector;
+
+    // a lookup we forwarded and wait for the next hop to acknowledge
+    // (failure detector)
+    struct WatchedHop {
+        Lookup_Req *req;        // a copy of the lookup, to send another way
+        Helper::NodeID next;    // the node it went to
+        cMessage *timer;        // goes off when the ack is overdue
+        int reroutes;           // times the lookup was sent another way already
+    };
+    typedef map<int64_t, WatchedHop> WatchedHopMap;     // by hop ID
+
+    // one connection per remote host, shared by all peers that live on it
+    typedef map<inet::L3Address, inet::TCPSocket *> ConnectionPool;
+
+    // a connection whose connect waits for others to complete first
+    struct DeferredConnect {
+        inet::TCPSocket *socket;
+        inet::L3Address addr;
+    };
+    typedef deque<DeferredConnect> DeferredConnectQueue;
 
     /**
      *  constructor
@@ -61,26 +142,135 @@ class ChordNode : public cSimpleModule,
      */
     virtual ~ChordNode (void);
 
+    /**
+     * Churn (see ChurnDriver): the helper has just taken our host off the
+     * ring or put it back. A graceful leave hands the keys we store to
+     * their new owners; a crash loses them. While down we drop whatever
+     * reaches us.
+     */
+    void leave (bool graceful);
+    void join (void);
+
+    /**
+     * The RTT to the host of the given node that our Vivaldi coordinates
+     * predict; negative without coordinates or if we have not heard of
+     * the host yet.
+     */
+    simtime_t predicted_rtt (Helper::NodeID nodeID);
+
   private:
-    int myID_;               // our ID
+    Helper *helper_;         // ring layout and node directory of this process
+    Helper::NodeID myID_;    // our ID (that of our first virtual node)
+    int hostIndex_;          // index of our host in the chordHosts[] vector
     inet::L3Address localAddress_;    // our local address
     int localPort_;          // our local port we will listen on (from NED file)
-    int finger_table_size_;  // length of our finger table (= m, supplied as param to coordinator)
-    Helper::IntVector nodeList_;     // list of nodes passed from simulation from which we pick the fingers
+    int m_;                  // bits of the key space (supplied as param to coordinator)
+    const Helper::IDVector *nodeList_;   // list of nodes passed from simulation from which we pick the peers
+
+    // which transport we use. With the overlay transport, messages bypass the
+    // TCP/IP stack and are handed to the peer module directly after a delay
+    // from the latency model.
+    Helper::Transport transport_;
+    LatencyModel *latency_;
+    OverlayGateway *gateway_;   // of our partition
 
-    // maintain a finger table data structure here
-    Fingertable *ft_;
+    // the virtual nodes we run
+    VirtualNodeVector vnodes_;
+
+    // the routing state of all our virtual nodes (routingTable parameter)
+    RoutingTable *routing_;
+    RttEstimator rtt_;          // RTTs timed by the answers we receive
+    Vivaldi vivaldi_;           // our coordinates and those of the hosts we heard of (vivaldi)
+    TraceBuffer trace_;         // our trace points
+
+    // our connections to other hosts
+    ConnectionPool connPool_;
 
     // additional parameters
     inet::TCPSocket    *socket_;   // our main listening socket
+    inet::UDPSocket    udpSocket_; // our socket with the UDP transport
     inet::TCPSocketMap socketMap_; // map of sockets we maintain for connections we
                                    // make to our fingers or connections we have
                                    // received from our fingers or clients
 
-    //* @@@ FILL IN @@@ */
-    // the data structure you created to preserve state for relaying responses
-    /* your data member declaration goes here */
-    int callerID;
+    // the data structure to preserve state for relaying responses
+    CallerMap callerMap_;
+    int64_t nextCallerID_;
+    simtime_t callerLifetime_;
+
+    // messages held back until the connection they go out on is established
+    PendingMap pendingMap_;
+
+    // when we issued the connect for each of our active connections (by conn ID)
+    map<int, simtime_t> connectStartedAt_;
+
+    // With lazy connections, a peer is connected to when a message first
+    // goes to it rather than all at start-up. Either way, at most
+    // maxConnects_ connects are in progress at a time (0: no limit); the
+    // others wait their turn here.
+    bool lazyConnect_;
+    int maxConnects_;
+    DeferredConnectQueue deferredConnects_;
+    long connectsDeferred_;     // connects that had to wait
+
+    // our load counters, kept in the helper's load table
+    Helper::NodeLoad *load_;
+
+    // the key/value store for the keys our virtual nodes own
+    KVStore *store_;
+    StoreJobQueue storeJobs_;   // answers waiting for their service time
+    cMessage *storeTimer_;      // goes off when the first of them is done
+    simtime_t storeBusyUntil_;  // when the store is done with all of them
+    long kvGets_;               // store operations we served
+    long kvGetHits_;
+    long kvPuts_;
+    long kvDeletes_;
+    int64_t peakStoreBytes_;    // largest amount of data we held
+
+    // replication: the owner of a key passes puts and deletes on to the
+    // nodes of the next replicationFactor hosts after it on the ring
+    int replicationFactor_;
+    ReplicaRead replicaRead_;
+    long replicaUpdates_;       // puts and deletes applied as a replica
+    long replicaGets_;          // gets answered as a replica
+
+    // churn: whether our host is on the ring, and the periodic stabilization
+    // of our virtual nodes (stabilizeInterval, 0 for none)
+    bool up_;
+    simtime_t stabilizeInterval_;
+    cMessage *stabilizeTimer_;
+    long messagesDropped_;      // arrived while we were down
+    long maintenanceMsgs_;      // stabilization and key hand-over messages sent
+    long maintenanceBytes_;
+
+    // Failure detection: the next hop acknowledges every lookup we forward.
+    // A host that misses the deadline, its RTO from our RTT estimate the
+    // way TCP sets it (srtt + 4 rttvar) counted from when the lookup left
+    // us, is suspect until we hear from it or suspectPeriod_ passes;
+    // routing passes suspects over, and the lookup is sent another way
+    // right away.
+    bool failureDetector_;
+    simtime_t suspectMinTimeout_;       // lower bound of the RTO
+    simtime_t suspectInitialTimeout_;   // RTO of a host we have no sample of
+    simtime_t suspectPeriod_;
+    int maxReroutes_;
+    int successorListSize_;             // successors to fall back on
+    int64_t nextHopID_;
+    WatchedHopMap watchedHops_;
+    map<int, simtime_t> suspects_;      // suspect hosts, until when
+    long hopsWatched_;                  // forwarded lookups we waited for an ack of
+    long hopAcks_;                      // acks we sent
+    long suspicions_;
+    long suspicionsCleared_;            // suspects we heard from again
+    long reroutes_;
+    long reroutesAbandoned_;            // lookups with no other way left
+
+    static simsignal_t hopTimeSignal;
+    static simsignal_t queueTimeSignal;
+    static simsignal_t connSetupTimeSignal;
+    static simsignal_t storeTimeSignal;
+    static simsignal_t maintenanceBytesSignal;
+    static simsignal_t peerSuspectedSignal;
 
   protected:
     /**
@@ -148,20 +338,140 @@ class ChordNode : public cSimpleModule,
 
     //@{
 
-    /** build the finger table for this node */
+    /** open the links to the peers in our routing table */
     void init_finger_table ();
 
+    /** load our routing table and store from a ring snapshot; ids are our
+        virtual nodes */
+    void restore_snapshot (const RingSnapshot &snap, const Helper::IDVector &ids);
+
     /** find successor node given some key id*/
-    int successor (int id);
+    Helper::NodeID successor (Helper::NodeID id);
+
+    /** the predecessors and successors of our virtual nodes on the ring */
+    void update_neighbours (void);
+
+    /** one stabilization round: check our successors, then bring our
+        neighbours and routing table up to date with the ring */
+    void stabilize (void);
+
+    /** answer a successor check */
+    void serve_stabilize (Stabilize_Req *req, const Link &from);
+
+    /** send a stabilization or key hand-over message, counting it */
+    void send_maintenance (const Link &link, Chord_Msg *msg);
+
+    /** round-trip time we expect to the host running the given node: the
+        one we measured, else from our Vivaldi coordinates or, without them,
+        the latency model or the network topology; negative if unknown */
+    virtual simtime_t estimated_rtt (Helper::NodeID nodeID) override;
+
+    /** mean of the RTTs we measured; negative if none */
+    virtual simtime_t mean_rtt (void) override;
+
+    /** the helper's successor table for the given offsets */
+    virtual const Helper::IntVector *successor_table (const Helper::IDVector &offsets) override;
+
+    /** index of our virtual node owning the key, i.e., with the key in
+        (predecessor, node], or -1 if none of them does */
+    int owning_vnode (Helper::NodeID key);
+
+    /** is the given ID one of our virtual nodes */
+    virtual bool is_local (Helper::NodeID nodeID) override;
+
+    /** do we suspect the host of the given node of having failed */
+    virtual bool is_suspect (Helper::NodeID nodeID) override;
+
+    /** how long we wait for the ack of a lookup forwarded to the given node */
+    simtime_t ack_timeout (Helper::NodeID nodeID);
+
+    /** send the lookup to the given node and wait for its ack */
+    void watch_hop (Lookup_Req *req, Helper::NodeID next, int reroutes, simtime_t arrivedAt);
+
+    /** start the ack timer of a watched lookup that leaves us, or is lost */
+    void start_hop_timer (Chord_Msg *msg, bool lost);
+
+    /** acknowledge a lookup to the node that forwarded it to us */
+    void ack_hop (Lookup_Req *req, const Link &from);
+
+    /** the next hop has acknowledged a lookup */
+    void hop_acked (Lookup_Ack *ack);
+
+    /** the ack of a forwarded lookup is overdue: suspect the next hop and
+        send the lookup another way */
+    void hop_timeout (cMessage *timer);
+
+    /** stop waiting for any acks */
+    void forget_watched_hops (void);
+
+    /** ID of the node to which the lookup req for key is forwarded */
+    Helper::NodeID next_hop (Helper::NodeID key, Lookup_Req *req);
+
+    /** link to the host running the given node; with TCP this connects first
+        if we do not have a connection yet */
+    Link node_link (Helper::NodeID nodeID);
+
+    /** hand a message to the transport, or hold it until the connection is up */
+    void send_msg (const Link &link, Chord_Msg *msg, simtime_t arrivedAt);
+
+    /** make a message an answer to one that carried the given hopSentTS
+        and reached us at the given time */
+    void echo (Chord_Msg *msg, simtime_t echoTS, simtime_t arrivedAt);
+
+    /** handle a chord message that arrived from the given link */
+    void handle_chord_msg (Chord_Msg *cmsg, const Link &from);
+
+    /** handle a message from the UDP layer */
+    void udp_arrived (cMessage *msg);
+
+    /** send everything that was waiting for this socket to get connected */
+    void flush_pending (inet::TCPSocket *socket);
+
+    /** forget all state that refers to a socket which is going away */
+    void forget_socket (inet::TCPSocket *socket);
+
+    /** refresh the open socket count in our load counters */
+    void update_socket_count (void);
 
     /** serve the incoming lookup request */
-    void serve_lookup (Lookup_Req *req, inet::TCPSocket *socket);
+    void serve_lookup (Lookup_Req *req, const Link &from);
 
     /** relay the response up the chain */
     void relay_resp (Lookup_Resp *resp);
 
+    /** apply a store operation to our store, fill in its answer and
+        return the time the store takes for it */
+    simtime_t apply_store_op (Lookup_Req *req, KV_Resp *resp);
+
+    /** send the answer to a store operation once the store got to it and
+        spent the service time on it */
+    void queue_store_job (const Link &to, Lookup_Resp *resp, simtime_t arrivedAt, simtime_t service);
+
+    /** send the answers of the store operations that are done */
+    void store_timer (void);
+
+    /** the nodes holding a replica of the keys of the given owner: the next
+        nodes on the ring that run on hosts other than the owner's and each
+        other's, at most replicationFactor_ of them */
+    void replica_set (Helper::NodeID owner, Helper::IDVector &replicas);
+
+    /** do we hold a replica of the key */
+    bool is_replica (Helper::NodeID key);
+
+    /** pass a put or delete on to the replicas of the key */
+    void replicate (Helper::NodeID owner, KVStore::Key key, int op, int valueSize);
+
+    /** apply a put or delete passed on by the owner */
+    void apply_replica (Replicate_Msg *msg);
+
     /** Issues a connection command to a finger */
-    virtual inet::TCPSocket *connect (int fingerID);
+    virtual inet::TCPSocket *connect (Helper::NodeID fingerID);
+
+    /** issue the connect of a socket and note when we did */
+    void start_connect (inet::TCPSocket *socket, const inet::L3Address &addr);
+
+    /** issue deferred connects while we are below the limit */
+    void next_connect (void);
     //@}
 };
 
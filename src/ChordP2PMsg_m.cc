@@ -1,789 +0,0 @@
-//
-// Generated file, do not edit! Created by nedtool 5.0 from ChordP2PMsg.msg.
-//
-
-// Disable warnings about unused variables, empty switch stmts, etc:
-#ifdef _MSC_VER
-#  pragma warning(disable:4101)
-#  pragma warning(disable:4065)
-#endif
-
-#include <iostream>
-#include <sstream>
-#include "ChordP2PMsg_m.h"
-
-namespace omnetpp {
-
-// Template pack/unpack rules. They are declared *after* a1l type-specific pack functions for multiple reasons.
-// They are in the omnetpp namespace, to allow them to be found by argument-dependent lookup via the cCommBuffer argument
-
-// Packing/unpacking an std::vector
-template<typename T, typename A>
-void doParsimPacking(omnetpp::cCommBuffer *buffer, const std::vector<T,A>& v)
-{
-    int n = v.size();
-    doParsimPacking(buffer, n);
-    for (int i = 0; i < n; i++)
-        doParsimPacking(buffer, v[i]);
-}
-
-template<typename T, typename A>
-void doParsimUnpacking(omnetpp::cCommBuffer *buffer, std::vector<T,A>& v)
-{
-    int n;
-    doParsimUnpacking(buffer, n);
-    v.resize(n);
-    for (int i = 0; i < n; i++)
-        doParsimUnpacking(buffer, v[i]);
-}
-
-// Packing/unpacking an std::list
-template<typename T, typename A>
-void doParsimPacking(omnetpp::cCommBuffer *buffer, const std::list<T,A>& l)
-{
-    doParsimPacking(buffer, (int)l.size());
-    for (typename std::list<T,A>::const_iterator it = l.begin(); it != l.end(); ++it)
-        doParsimPacking(buffer, (T&)*it);
-}
-
-template<typename T, typename A>
-void doParsimUnpacking(omnetpp::cCommBuffer *buffer, std::list<T,A>& l)
-{
-    int n;
-    doParsimUnpacking(buffer, n);
-    for (int i=0; i<n; i++) {
-        l.push_back(T());
-        doParsimUnpacking(buffer, l.back());
-    }
-}
-
-// Packing/unpacking an std::set
-template<typename T, typename Tr, typename A>
-void doParsimPacking(omnetpp::cCommBuffer *buffer, const std::set<T,Tr,A>& s)
-{
-    doParsimPacking(buffer, (int)s.size());
-    for (typename std::set<T,Tr,A>::const_iterator it = s.begin(); it != s.end(); ++it)
-        doParsimPacking(buffer, *it);
-}
-
-template<typename T, typename Tr, typename A>
-void doParsimUnpacking(omnetpp::cCommBuffer *buffer, std::set<T,Tr,A>& s)
-{
-    int n;
-    doParsimUnpacking(buffer, n);
-    for (int i=0; i<n; i++) {
-        T x;
-        doParsimUnpacking(buffer, x);
-        s.insert(x);
-    }
-}
-
-// Packing/unpacking an std::map
-template<typename K, typename V, typename Tr, typename A>
-void doParsimPacking(omnetpp::cCommBuffer *buffer, const std::map<K,V,Tr,A>& m)
-{
-    doParsimPacking(buffer, (int)m.size());
-    for (typename std::map<K,V,Tr,A>::const_iterator it = m.begin(); it != m.end(); ++it) {
-        doParsimPacking(buffer, it->first);
-        doParsimPacking(buffer, it->second);
-    }
-}
-
-template<typename K, typename V, typename Tr, typename A>
-void doParsimUnpacking(omnetpp::cCommBuffer *buffer, std::map<K,V,Tr,A>& m)
-{
-    int n;
-    doParsimUnpacking(buffer, n);
-    for (int i=0; i<n; i++) {
-        K k; V v;
-        doParsimUnpacking(buffer, k);
-        doParsimUnpacking(buffer, v);
-        m[k] = v;
-    }
-}
-
-// Default pack/unpack function for arrays
-template<typename T>
-void doParsimArrayPacking(omnetpp::cCommBuffer *b, const T *t, int n)
-{
-    for (int i = 0; i < n; i++)
-        doParsimPacking(b, t[i]);
-}
-
-template<typename T>
-void doParsimArrayUnpacking(omnetpp::cCommBuffer *b, T *t, int n)
-{
-    for (int i = 0; i < n; i++)
-        doParsimUnpacking(b, t[i]);
-}
-
-// Default rule to prevent compiler from choosing base class' doParsimPacking() function
-template<typename T>
-void doParsimPacking(omnetpp::cCommBuffer *, const T& t)
-{
-    throw omnetpp::cRuntimeError("Parsim error: no doParsimPacking() function for type %s", omnetpp::opp_typename(typeid(t)));
-}
-
-template<typename T>
-void doParsimUnpacking(omnetpp::cCommBuffer *, T& t)
-{
-    throw omnetpp::cRuntimeError("Parsim error: no doParsimUnpacking() function for type %s", omnetpp::opp_typename(typeid(t)));
-}
-
-}  // namespace omnetpp
-
-
-// forward
-template<typename T, typename A>
-std::ostream& operator<<(std::ostream& out, const std::vector<T,A>& vec);
-
-// Template rule which fires if a struct or class doesn't have operator<<
-template<typename T>
-inline std::ostream& operator<<(std::ostream& out,const T&) {return out;}
-
-// operator<< for std::vector<T>
-template<typename T, typename A>
-inline std::ostream& operator<<(std::ostream& out, const std::vector<T,A>& vec)
-{
-    out.put('{');
-    for(typename std::vector<T,A>::const_iterator it = vec.begin(); it != vec.end(); ++it)
-    {
-        if (it != vec.begin()) {
-            out.put(','); out.put(' ');
-        }
-        out << *it;
-    }
-    out.put('}');
-    
-    char buf[32];
-    sprintf(buf, " (size=%u)", (unsigned int)vec.size());
-    out.write(buf, strlen(buf));
-    return out;
-}
-
-Register_Class(Lookup_Req);
-
-Lookup_Req::Lookup_Req(const char *name, int kind) : ::omnetpp::cPacket(name,kind)
-{
-    this->key = 0;
-}
-
-Lookup_Req::Lookup_Req(const Lookup_Req& other) : ::omnetpp::cPacket(other)
-{
-    copy(other);
-}
-
-Lookup_Req::~Lookup_Req()
-{
-}
-
-Lookup_Req& Lookup_Req::operator=(const Lookup_Req& other)
-{
-    if (this==&other) return *this;
-    ::omnetpp::cPacket::operator=(other);
-    copy(other);
-    return *this;
-}
-
-void Lookup_Req::copy(const Lookup_Req& other)
-{
-    this->key = other.key;
-    this->sender = other.sender;
-}
-
-void Lookup_Req::parsimPack(omnetpp::cCommBuffer *b) const
-{
-    ::omnetpp::cPacket::parsimPack(b);
-    doParsimPacking(b,this->key);
-    doParsimPacking(b,this->sender);
-}
-
-void Lookup_Req::parsimUnpack(omnetpp::cCommBuffer *b)
-{
-    ::omnetpp::cPacket::parsimUnpack(b);
-    doParsimUnpacking(b,this->key);
-    doParsimUnpacking(b,this->sender);
-}
-
-long Lookup_Req::getKey() const
-{
-    return this->key;
-}
-
-void Lookup_Req::setKey(long key)
-{
-    this->key = key;
-}
-
-const char * Lookup_Req::getSender() const
-{
-    return this->sender.c_str();
-}
-
-void Lookup_Req::setSender(const char * sender)
-{
-    this->sender = sender;
-}
-
-class Lookup_ReqDescriptor : public omnetpp::cClassDescriptor
-{
-  private:
-    mutable const char **propertynames;
-  public:
-    Lookup_ReqDescriptor();
-    virtual ~Lookup_ReqDescriptor();
-
-    virtual bool doesSupport(omnetpp::cObject *obj) const override;
-    virtual const char **getPropertyNames() const override;
-    virtual const char *getProperty(const char *propertyname) const override;
-    virtual int getFieldCount() const override;
-    virtual const char *getFieldName(int field) const override;
-    virtual int findField(const char *fieldName) const override;
-    virtual unsigned int getFieldTypeFlags(int field) const override;
-    virtual const char *getFieldTypeString(int field) const override;
-    virtual const char **getFieldPropertyNames(int field) const override;
-    virtual const char *getFieldProperty(int field, const char *propertyname) const override;
-    virtual int getFieldArraySize(void *object, int field) const override;
-
-    virtual std::string getFieldValueAsString(void *object, int field, int i) const override;
-    virtual bool setFieldValueAsString(void *object, int field, int i, const char *value) const override;
-
-    virtual const char *getFieldStructName(int field) const override;
-    virtual void *getFieldStructValuePointer(void *object, int field, int i) const override;
-};
-
-Register_ClassDescriptor(Lookup_ReqDescriptor);
-
-Lookup_ReqDescriptor::Lookup_ReqDescriptor() : omnetpp::cClassDescriptor("Lookup_Req", "omnetpp::cPacket")
-{
-    propertynames = nullptr;
-}
-
-Lookup_ReqDescriptor::~Lookup_ReqDescriptor()
-{
-    delete[] propertynames;
-}
-
-bool Lookup_ReqDescriptor::doesSupport(omnetpp::cObject *obj) const
-{
-    return dynamic_cast<Lookup_Req *>(obj)!=nullptr;
-}
-
-const char **Lookup_ReqDescriptor::getPropertyNames() const
-{
-    if (!propertynames) {
-        static const char *names[] = {  nullptr };
-        omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-        const char **basenames = basedesc ? basedesc->getPropertyNames() : nullptr;
-        propertynames = mergeLists(basenames, names);
-    }
-    return propertynames;
-}
-
-const char *Lookup_ReqDescriptor::getProperty(const char *propertyname) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? basedesc->getProperty(propertyname) : nullptr;
-}
-
-int Lookup_ReqDescriptor::getFieldCount() const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? 2+basedesc->getFieldCount() : 2;
-}
-
-unsigned int Lookup_ReqDescriptor::getFieldTypeFlags(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldTypeFlags(field);
-        field -= basedesc->getFieldCount();
-    }
-    static unsigned int fieldTypeFlags[] = {
-        FD_ISEDITABLE,
-        FD_ISEDITABLE,
-    };
-    return (field>=0 && field<2) ? fieldTypeFlags[field] : 0;
-}
-
-const char *Lookup_ReqDescriptor::getFieldName(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldName(field);
-        field -= basedesc->getFieldCount();
-    }
-    static const char *fieldNames[] = {
-        "key",
-        "sender",
-    };
-    return (field>=0 && field<2) ? fieldNames[field] : nullptr;
-}
-
-int Lookup_ReqDescriptor::findField(const char *fieldName) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    int base = basedesc ? basedesc->getFieldCount() : 0;
-    if (fieldName[0]=='k' && strcmp(fieldName, "key")==0) return base+0;
-    if (fieldName[0]=='s' && strcmp(fieldName, "sender")==0) return base+1;
-    return basedesc ? basedesc->findField(fieldName) : -1;
-}
-
-const char *Lookup_ReqDescriptor::getFieldTypeString(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldTypeString(field);
-        field -= basedesc->getFieldCount();
-    }
-    static const char *fieldTypeStrings[] = {
-        "long",
-        "string",
-    };
-    return (field>=0 && field<2) ? fieldTypeStrings[field] : nullptr;
-}
-
-const char **Lookup_ReqDescriptor::getFieldPropertyNames(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldPropertyNames(field);
-        field -= basedesc->getFieldCount();
-    }
-    switch (field) {
-        default: return nullptr;
-    }
-}
-
-const char *Lookup_ReqDescriptor::getFieldProperty(int field, const char *propertyname) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldProperty(field, propertyname);
-        field -= basedesc->getFieldCount();
-    }
-    switch (field) {
-        default: return nullptr;
-    }
-}
-
-int Lookup_ReqDescriptor::getFieldArraySize(void *object, int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldArraySize(object, field);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Req *pp = (Lookup_Req *)object; (void)pp;
-    switch (field) {
-        default: return 0;
-    }
-}
-
-std::string Lookup_ReqDescriptor::getFieldValueAsString(void *object, int field, int i) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldValueAsString(object,field,i);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Req *pp = (Lookup_Req *)object; (void)pp;
-    switch (field) {
-        case 0: return long2string(pp->getKey());
-        case 1: return oppstring2string(pp->getSender());
-        default: return "";
-    }
-}
-
-bool Lookup_ReqDescriptor::setFieldValueAsString(void *object, int field, int i, const char *value) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->setFieldValueAsString(object,field,i,value);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Req *pp = (Lookup_Req *)object; (void)pp;
-    switch (field) {
-        case 0: pp->setKey(string2long(value)); return true;
-        case 1: pp->setSender((value)); return true;
-        default: return false;
-    }
-}
-
-const char *Lookup_ReqDescriptor::getFieldStructName(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldStructName(field);
-        field -= basedesc->getFieldCount();
-    }
-    switch (field) {
-        default: return nullptr;
-    };
-}
-
-void *Lookup_ReqDescriptor::getFieldStructValuePointer(void *object, int field, int i) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldStructValuePointer(object, field, i);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Req *pp = (Lookup_Req *)object; (void)pp;
-    switch (field) {
-        default: return nullptr;
-    }
-}
-
-Register_Class(Lookup_Resp);
-
-Lookup_Resp::Lookup_Resp(const char *name, int kind) : ::omnetpp::cPacket(name,kind)
-{
-    this->key = 0;
-    responder_arraysize = 0;
-    this->responder = 0;
-}
-
-Lookup_Resp::Lookup_Resp(const Lookup_Resp& other) : ::omnetpp::cPacket(other)
-{
-    responder_arraysize = 0;
-    this->responder = 0;
-    copy(other);
-}
-
-Lookup_Resp::~Lookup_Resp()
-{
-    delete [] this->responder;
-}
-
-Lookup_Resp& Lookup_Resp::operator=(const Lookup_Resp& other)
-{
-    if (this==&other) return *this;
-    ::omnetpp::cPacket::operator=(other);
-    copy(other);
-    return *this;
-}
-
-void Lookup_Resp::copy(const Lookup_Resp& other)
-{
-    this->key = other.key;
-    this->sender = other.sender;
-    delete [] this->responder;
-    this->responder = (other.responder_arraysize==0) ? nullptr : new omnetpp::opp_string[other.responder_arraysize];
-    responder_arraysize = other.responder_arraysize;
-    for (unsigned int i=0; i<responder_arraysize; i++)
-        this->responder[i] = other.responder[i];
-}
-
-void Lookup_Resp::parsimPack(omnetpp::cCommBuffer *b) const
-{
-    ::omnetpp::cPacket::parsimPack(b);
-    doParsimPacking(b,this->key);
-    doParsimPacking(b,this->sender);
-    b->pack(responder_arraysize);
-    doParsimArrayPacking(b,this->responder,responder_arraysize);
-}
-
-void Lookup_Resp::parsimUnpack(omnetpp::cCommBuffer *b)
-{
-    ::omnetpp::cPacket::parsimUnpack(b);
-    doParsimUnpacking(b,this->key);
-    doParsimUnpacking(b,this->sender);
-    delete [] this->responder;
-    b->unpack(responder_arraysize);
-    if (responder_arraysize==0) {
-        this->responder = 0;
-    } else {
-        this->responder = new omnetpp::opp_string[responder_arraysize];
-        doParsimArrayUnpacking(b,this->responder,responder_arraysize);
-    }
-}
-
-long Lookup_Resp::getKey() const
-{
-    return this->key;
-}
-
-void Lookup_Resp::setKey(long key)
-{
-    this->key = key;
-}
-
-const char * Lookup_Resp::getSender() const
-{
-    return this->sender.c_str();
-}
-
-void Lookup_Resp::setSender(const char * sender)
-{
-    this->sender = sender;
-}
-
-void Lookup_Resp::setResponderArraySize(unsigned int size)
-{
-    omnetpp::opp_string *responder2 = (size==0) ? nullptr : new omnetpp::opp_string[size];
-    unsigned int sz = responder_arraysize < size ? responder_arraysize : size;
-    for (unsigned int i=0; i<sz; i++)
-        responder2[i] = this->responder[i];
-    for (unsigned int i=sz; i<size; i++)
-        responder2[i] = 0;
-    responder_arraysize = size;
-    delete [] this->responder;
-    this->responder = responder2;
-}
-
-unsigned int Lookup_Resp::getResponderArraySize() const
-{
-    return responder_arraysize;
-}
-
-const char * Lookup_Resp::getResponder(unsigned int k) const
-{
-    if (k>=responder_arraysize) throw omnetpp::cRuntimeError("Array of size %d indexed by %d", responder_arraysize, k);
-    return this->responder[k].c_str();
-}
-
-void Lookup_Resp::setResponder(unsigned int k, const char * responder)
-{
-    if (k>=responder_arraysize) throw omnetpp::cRuntimeError("Array of size %d indexed by %d", responder_arraysize, k);
-    this->responder[k] = responder;
-}
-
-class Lookup_RespDescriptor : public omnetpp::cClassDescriptor
-{
-  private:
-    mutable const char **propertynames;
-  public:
-    Lookup_RespDescriptor();
-    virtual ~Lookup_RespDescriptor();
-
-    virtual bool doesSupport(omnetpp::cObject *obj) const override;
-    virtual const char **getPropertyNames() const override;
-    virtual const char *getProperty(const char *propertyname) const override;
-    virtual int getFieldCount() const override;
-    virtual const char *getFieldName(int field) const override;
-    virtual int findField(const char *fieldName) const override;
-    virtual unsigned int getFieldTypeFlags(int field) const override;
-    virtual const char *getFieldTypeString(int field) const override;
-    virtual const char **getFieldPropertyNames(int field) const override;
-    virtual const char *getFieldProperty(int field, const char *propertyname) const override;
-    virtual int getFieldArraySize(void *object, int field) const override;
-
-    virtual std::string getFieldValueAsString(void *object, int field, int i) const override;
-    virtual bool setFieldValueAsString(void *object, int field, int i, const char *value) const override;
-
-    virtual const char *getFieldStructName(int field) const override;
-    virtual void *getFieldStructValuePointer(void *object, int field, int i) const override;
-};
-
-Register_ClassDescriptor(Lookup_RespDescriptor);
-
-Lookup_RespDescriptor::Lookup_RespDescriptor() : omnetpp::cClassDescriptor("Lookup_Resp", "omnetpp::cPacket")
-{
-    propertynames = nullptr;
-}
-
-Lookup_RespDescriptor::~Lookup_RespDescriptor()
-{
-    delete[] propertynames;
-}
-
-bool Lookup_RespDescriptor::doesSupport(omnetpp::cObject *obj) const
-{
-    return dynamic_cast<Lookup_Resp *>(obj)!=nullptr;
-}
-
-const char **Lookup_RespDescriptor::getPropertyNames() const
-{
-    if (!propertynames) {
-        static const char *names[] = {  nullptr };
-        omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-        const char **basenames = basedesc ? basedesc->getPropertyNames() : nullptr;
-        propertynames = mergeLists(basenames, names);
-    }
-    return propertynames;
-}
-
-const char *Lookup_RespDescriptor::getProperty(const char *propertyname) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? basedesc->getProperty(propertyname) : nullptr;
-}
-
-int Lookup_RespDescriptor::getFieldCount() const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? 3+basedesc->getFieldCount() : 3;
-}
-
-unsigned int Lookup_RespDescriptor::getFieldTypeFlags(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldTypeFlags(field);
-        field -= basedesc->getFieldCount();
-    }
-    static unsigned int fieldTypeFlags[] = {
-        FD_ISEDITABLE,
-        FD_ISEDITABLE,
-        FD_ISARRAY | FD_ISEDITABLE,
-    };
-    return (field>=0 && field<3) ? fieldTypeFlags[field] : 0;
-}
-
-const char *Lookup_RespDescriptor::getFieldName(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldName(field);
-        field -= basedesc->getFieldCount();
-    }
-    static const char *fieldNames[] = {
-        "key",
-        "sender",
-        "responder",
-    };
-    return (field>=0 && field<3) ? fieldNames[field] : nullptr;
-}
-
-int Lookup_RespDescriptor::findField(const char *fieldName) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    int base = basedesc ? basedesc->getFieldCount() : 0;
-    if (fieldName[0]=='k' && strcmp(fieldName, "key")==0) return base+0;
-    if (fieldName[0]=='s' && strcmp(fieldName, "sender")==0) return base+1;
-    if (fieldName[0]=='r' && strcmp(fieldName, "responder")==0) return base+2;
-    return basedesc ? basedesc->findField(fieldName) : -1;
-}
-
-const char *Lookup_RespDescriptor::getFieldTypeString(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldTypeString(field);
-        field -= basedesc->getFieldCount();
-    }
-    static const char *fieldTypeStrings[] = {
-        "long",
-        "string",
-        "string",
-    };
-    return (field>=0 && field<3) ? fieldTypeStrings[field] : nullptr;
-}
-
-const char **Lookup_RespDescriptor::getFieldPropertyNames(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldPropertyNames(field);
-        field -= basedesc->getFieldCount();
-    }
-    switch (field) {
-        default: return nullptr;
-    }
-}
-
-const char *Lookup_RespDescriptor::getFieldProperty(int field, const char *propertyname) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldProperty(field, propertyname);
-        field -= basedesc->getFieldCount();
-    }
-    switch (field) {
-        default: return nullptr;
-    }
-}
-
-int Lookup_RespDescriptor::getFieldArraySize(void *object, int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldArraySize(object, field);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Resp *pp = (Lookup_Resp *)object; (void)pp;
-    switch (field) {
-        case 2: return pp->getResponderArraySize();
-        default: return 0;
-    }
-}
-
-std::string Lookup_RespDescriptor::getFieldValueAsString(void *object, int field, int i) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldValueAsString(object,field,i);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Resp *pp = (Lookup_Resp *)object; (void)pp;
-    switch (field) {
-        case 0: return long2string(pp->getKey());
-        case 1: return oppstring2string(pp->getSender());
-        case 2: return oppstring2string(pp->getResponder(i));
-        default: return "";
-    }
-}
-
-bool Lookup_RespDescriptor::setFieldValueAsString(void *object, int field, int i, const char *value) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->setFieldValueAsString(object,field,i,value);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Resp *pp = (Lookup_Resp *)object; (void)pp;
-    switch (field) {
-        case 0: pp->setKey(string2long(value)); return true;
-        case 1: pp->setSender((value)); return true;
-        case 2: pp->setResponder(i,(value)); return true;
-        default: return false;
-    }
-}
-
-const char *Lookup_RespDescriptor::getFieldStructName(int field) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldStructName(field);
-        field -= basedesc->getFieldCount();
-    }
-    switch (field) {
-        default: return nullptr;
-    };
-}
-
-void *Lookup_RespDescriptor::getFieldStructValuePointer(void *object, int field, int i) const
-{
-    omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    if (basedesc) {
-        if (field < basedesc->getFieldCount())
-            return basedesc->getFieldStructValuePointer(object, field, i);
-        field -= basedesc->getFieldCount();
-    }
-    Lookup_Resp *pp = (Lookup_Resp *)object; (void)pp;
-    switch (field) {
-        default: return nullptr;
-    }
-}
-
-
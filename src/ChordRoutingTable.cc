@@ -0,0 +1,265 @@
+/*
+ * ChordRoutingTable.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "ChordRoutingTable.h"
+
+ChordRoutingTable::ChordRoutingTable (RoutingTable::Owner *owner, const Helper::IDVector &ring, int m,
+                                      int fingerBits, int pnsCandidates, const string &routeSelection,
+                                      double prsHopWeight)
+    : RoutingTable (owner, ring, m),
+      tables_ (),
+      fingerBits_ (fingerBits),
+      pnsCandidates_ (pnsCandidates),
+      routeSelection_ (ChordRoutingTable::PROGRESS),
+      prsHopWeight_ (prsHopWeight),
+      fingerRttSum_ (0.0),
+      numFingerRtts_ (0),
+      prsDetours_ (0)
+{
+    if (this->fingerBits_ < 1 || this->fingerBits_ > m)
+        throw cRuntimeError ("ChordRoutingTable -- fingerBits must be in [1, m = %d], not %d", m, fingerBits);
+    if (this->pnsCandidates_ < 1)
+        throw cRuntimeError ("ChordRoutingTable -- pnsCandidates must be at least 1");
+    if (routeSelection == "progress")
+        this->routeSelection_ = ChordRoutingTable::PROGRESS;
+    else if (routeSelection == "latency")
+        this->routeSelection_ = ChordRoutingTable::LATENCY;
+    else
+        throw cRuntimeError ("ChordRoutingTable -- unknown route selection \"%s\"", routeSelection.c_str ());
+}
+
+void ChordRoutingTable::layout (vector<Finger> &fingers, Helper::IDVector &offsets) const
+{
+    // With b = fingerBits, there is a finger at id + j * 2^(b*l) for every
+    // digit j in [1, 2^b) and level l (modulo the key space), the successor
+    // of that ID; b = 1 gives the classic fingers at id + 2^i. Each finger
+    // covers the 2^(b*l) IDs up to the next one.
+    Helper::NodeID digits = ((Helper::NodeID) 1) << this->fingerBits_;
+    for (int level = 0; level * this->fingerBits_ < this->m_; level++) {
+        Helper::NodeID span = ((Helper::NodeID) 1) << (level * this->fingerBits_);
+        for (Helper::NodeID j = 1; j < digits && j * span < this->keySpace_; j++) {
+            ChordRoutingTable::Finger f;
+            f.start = j * span;
+            f.span = std::min (span, this->keySpace_ - f.start);
+            f.node = -1;
+            fingers.push_back (f);
+            offsets.push_back (f.start);
+        }
+    }
+}
+
+void ChordRoutingTable::build (const Helper::IDVector &vnodes)
+{
+    vector<Finger> fingers;
+    Helper::IDVector offsets;
+    this->layout (fingers, offsets);
+
+    // The successors come from the table shared by all the nodes if there is
+    // one. With proximity neighbour selection a finger may then be any node
+    // of its interval; the first finger stays the immediate successor all
+    // the same.
+    const Helper::IntVector *shared = this->owner_->successor_table (offsets);
+    this->tables_.clear ();
+    for (Helper::IDVector::const_iterator vit = vnodes.begin (); vit != vnodes.end (); ++vit) {
+        ChordRoutingTable::Table t;
+        t.id = *vit;
+        t.fingers = fingers;
+        const int *row = shared ? &(*shared)[this->position (t.id) * fingers.size ()] : nullptr;
+        for (size_t i = 0; i < t.fingers.size (); i++) {
+            ChordRoutingTable::Finger &f = t.fingers[i];
+            Helper::NodeID id = (t.id + f.start) % this->keySpace_;
+            f.node = row ? this->ring_[row[i]] : this->successor (id);
+            if (i > 0 && this->pnsCandidates_ > 1)
+                f.node = this->closest_candidate (t, f, f.node);
+
+            if (this->pnsCandidates_ > 1 && !this->owner_->is_local (f.node)) {
+                simtime_t rtt = this->owner_->estimated_rtt (f.node);
+                if (rtt >= SIMTIME_ZERO) {
+                    this->fingerRttSum_ += rtt.dbl ();
+                    this->numFingerRtts_++;
+                }
+            }
+
+            EV << "=== ChordRoutingTable::build NodeID: " << t.id
+               << " finger[" << i << "] start = " << id
+               << ", node = " << f.node << endl;
+        }
+        this->tables_.push_back (t);
+    }
+    this->built_ = true;
+}
+
+Helper::NodeID ChordRoutingTable::closest_candidate (const ChordRoutingTable::Table &t,
+                                                     const ChordRoutingTable::Finger &f,
+                                                     Helper::NodeID suc)
+{
+    // a node c is in the interval of the finger when start <= c - id <
+    // start + span; the nodes in it follow suc on the ring
+    if (this->owner_->is_local (suc))
+        return suc;     // costs nothing to reach
+
+    size_t n = this->ring_.size ();
+    size_t pos = this->position (suc);
+
+    Helper::NodeID best = suc;
+    simtime_t bestRtt = this->owner_->estimated_rtt (suc);
+    for (int k = 1; k < this->pnsCandidates_ && k < (int) n; ++k) {
+        Helper::NodeID c = this->ring_[(pos + k) % n];
+        Helper::NodeID dist = this->distance (t.id, c);
+        if (dist < f.start || dist - f.start >= f.span)
+            break;      // past the end of the interval
+        if (this->owner_->is_local (c))
+            continue;   // we never forward to ourselves
+        simtime_t rtt = this->owner_->estimated_rtt (c);
+        if (rtt >= SIMTIME_ZERO && (bestRtt < SIMTIME_ZERO || rtt < bestRtt)) {
+            best = c;
+            bestRtt = rtt;
+        }
+    }
+
+    EV << "=== ChordRoutingTable::closest_candidate NodeID: " << t.id
+       << " finger at +" << f.start << " successor = " << suc << ", picked = " << best
+       << " (rtt " << bestRtt << ")" << endl;
+    return best;
+}
+
+Helper::NodeID ChordRoutingTable::next_hop (Helper::NodeID key, Lookup_Req *)
+{
+    // pick, over all our finger tables, the finger that precedes the key most
+    // closely. That is never worse than what our virtual node closest to the
+    // key would pick on its own, and it is never one of our own virtual nodes
+    // since those are all further from the key.
+    Helper::NodeID best = -1;
+    Helper::NodeID bestDist = this->keySpace_;
+    for (vector<Table>::iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        for (int i = tit->fingers.size () - 1; i >= 0; --i) {
+            Helper::NodeID f = tit->fingers[i].node;
+            if (!Helper::in_interval (f, tit->id, key, false) || !this->usable (f))
+                continue;
+            Helper::NodeID dist = this->distance (f, key);
+            if (dist < bestDist) {
+                best = f;
+                bestDist = dist;
+            }
+            break;  // lower fingers of this table are further from the key
+        }
+    }
+    if (best < 0)
+        return this->tables_[0].fingers[0].node;
+    if (this->routeSelection_ == ChordRoutingTable::PROGRESS)
+        return best;
+
+    // Proximity route selection: every finger preceding the key makes some
+    // progress; take the one of lowest cost. A nearby finger that leaves a
+    // few more hops to go may still beat the closest one to the key.
+    // Until we have measured anything, the RTT to the closest finger stands
+    // in for the mean; with no idea of distances at all we stay greedy.
+    simtime_t mean = this->owner_->mean_rtt ();
+    if (mean < SIMTIME_ZERO)
+        mean = this->owner_->estimated_rtt (best);
+    if (mean <= SIMTIME_ZERO)
+        return best;
+    double meanRtt = mean.dbl ();
+    Helper::NodeID greedy = best;
+    double bestCost = this->route_cost (best, key, meanRtt);
+    for (vector<Table>::iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        for (int i = tit->fingers.size () - 1; i >= 0; --i) {
+            Helper::NodeID f = tit->fingers[i].node;
+            if (f == best || !Helper::in_interval (f, tit->id, key, false) || !this->usable (f))
+                continue;
+            double cost = this->route_cost (f, key, meanRtt);
+            if (cost < bestCost) {
+                best = f;
+                bestCost = cost;
+            }
+        }
+    }
+    if (best != greedy)
+        this->prsDetours_++;
+    return best;
+}
+
+double ChordRoutingTable::route_cost (Helper::NodeID f, Helper::NodeID key, double meanRtt)
+{
+    // From f, log base 2^b of the number of ring nodes between f and the key
+    // digits are still to fix, each but a fraction 2^-b of them taking a
+    // hop of a mean RTT (half of log2 with plain fingers). A finger we know
+    // nothing about counts as being at the mean distance.
+    double dist = (double) this->distance (f, key);
+    double between = dist * this->ring_.size () / this->keySpace_;
+    double hops = (1.0 - ldexp (1.0, -this->fingerBits_)) * log2 (1.0 + between) / this->fingerBits_;
+
+    simtime_t rtt = this->owner_->estimated_rtt (f);
+    double r = (rtt >= SIMTIME_ZERO) ? rtt.dbl () : meanRtt;
+    return r + this->prsHopWeight_ * hops * meanRtt;
+}
+
+void ChordRoutingTable::save (Helper::IDVector &state) const
+{
+    // per virtual node: its ID and number of fingers, then the node of each
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        state.push_back (tit->id);
+        state.push_back (tit->fingers.size ());
+        for (vector<Finger>::const_iterator fit = tit->fingers.begin (); fit != tit->fingers.end (); ++fit)
+            state.push_back (fit->node);
+    }
+}
+
+bool ChordRoutingTable::restore (const Helper::IDVector &vnodes, const Helper::IDVector &state)
+{
+    vector<Finger> fingers;
+    Helper::IDVector offsets;
+    this->layout (fingers, offsets);
+
+    this->tables_.clear ();
+    size_t pos = 0;
+    for (Helper::IDVector::const_iterator vit = vnodes.begin (); vit != vnodes.end (); ++vit) {
+        if (pos + 2 > state.size () || state[pos] != *vit || state[pos + 1] != (Helper::NodeID) fingers.size ()
+                || pos + 2 + fingers.size () > state.size ())
+            throw cRuntimeError ("ChordRoutingTable::restore -- the snapshot does not match node %lld "
+                                 "with %d fingers (was fingerBits changed?)", (long long) *vit, (int) fingers.size ());
+        ChordRoutingTable::Table t;
+        t.id = *vit;
+        t.fingers = fingers;
+        for (size_t i = 0; i < t.fingers.size (); ++i)
+            t.fingers[i].node = state[pos + 2 + i];
+        pos += 2 + fingers.size ();
+        this->tables_.push_back (t);
+    }
+    this->built_ = true;
+    return true;
+}
+
+void ChordRoutingTable::peers (Helper::IDVector &ids) const
+{
+    set<Helper::NodeID> seen;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        for (vector<Finger>::const_iterator fit = tit->fingers.begin (); fit != tit->fingers.end (); ++fit) {
+            if (seen.insert (fit->node).second)
+                ids.push_back (fit->node);
+        }
+    }
+}
+
+size_t ChordRoutingTable::state_size (void) const
+{
+    size_t n = 0;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit)
+        n += tit->fingers.size ();
+    return n;
+}
+
+void ChordRoutingTable::record_scalars (cComponent *node)
+{
+    if (this->numFingerRtts_ > 0)
+        node->recordScalar ("meanFingerRtt", this->fingerRttSum_ / this->numFingerRtts_);
+    if (this->routeSelection_ != ChordRoutingTable::PROGRESS)
+        node->recordScalar ("prsDetours", this->prsDetours_);
+}
@@ -0,0 +1,92 @@
+/*
+ * ChordRoutingTable.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_CHORDROUTINGTABLE_H_
+#define CS6381_CHORD_P2P_CHORDROUTINGTABLE_H_
+
+#include <vector>
+using namespace std;
+
+#include "RoutingTable.h"
+
+/**
+ * Chord finger tables. A virtual node with ID id has a finger at the
+ * successor of id + j * (2^b)^l for every level l and digit j in [1, 2^b),
+ * with b = fingerBits; a lookup goes to the finger preceding the key most
+ * closely, over the tables of all our virtual nodes. Plain chord has b = 1
+ * (fingers at id + 2^i) and takes about log2(N) / 2 hops; a larger b fixes
+ * a base-2^b digit per hop, taking about log_{2^b}(N) hops for (2^b - 1)
+ * times the fingers per level.
+ *
+ * Two proximity options trade ID space progress for network distance:
+ *
+ *   neighbour selection -- a finger may be any node of
+ *       its interval, up to the next finger, and still makes the same
+ *       progress towards the key; of the first pnsCandidates of them the
+ *       closest is taken.
+ *   route selection -- with routeSelection "latency" the lookup goes to the
+ *       preceding finger of lowest
+ *         rtt + prsHopWeight * (expected remaining hops) * (mean rtt)
+ *       rather than to the one closest to the key.
+ */
+class ChordRoutingTable : public RoutingTable {
+public:
+    // how next_hop picks among the fingers preceding the key
+    enum RouteSelection {
+        PROGRESS,   // the one closest to the key (plain chord)
+        LATENCY     // lowest RTT plus expected remaining hops times the mean RTT
+    };
+
+    ChordRoutingTable (Owner *owner, const Helper::IDVector &ring, int m,
+                       int fingerBits, int pnsCandidates, const string &routeSelection,
+                       double prsHopWeight);
+
+    virtual void build (const Helper::IDVector &vnodes) override;
+    virtual Helper::NodeID next_hop (Helper::NodeID key, Lookup_Req *req) override;
+    virtual void peers (Helper::IDVector &ids) const override;
+    virtual size_t state_size (void) const override;
+    virtual void record_scalars (cComponent *node) override;
+    virtual void save (Helper::IDVector &state) const override;
+    virtual bool restore (const Helper::IDVector &vnodes, const Helper::IDVector &state) override;
+
+private:
+    struct Finger {
+        Helper::NodeID start;   // offset of the finger's interval from the node
+        Helper::NodeID span;    // length of the interval
+        Helper::NodeID node;    // the node it points to
+    };
+
+    // the fingers of one virtual node, by increasing offset
+    struct Table {
+        Helper::NodeID id;
+        vector<Finger> fingers;
+    };
+
+    // the fingers of a table with their intervals but no nodes yet, and
+    // their offsets
+    void layout (vector<Finger> &fingers, Helper::IDVector &offsets) const;
+
+    // of the first pnsCandidates_ nodes in the interval of a finger,
+    // starting with its successor suc, the one with the lowest RTT
+    Helper::NodeID closest_candidate (const Table &t, const Finger &f, Helper::NodeID suc);
+
+    // cost of forwarding a lookup for key to finger f under proximity route
+    // selection, given the mean RTT
+    double route_cost (Helper::NodeID f, Helper::NodeID key, double meanRtt);
+
+    vector<Table> tables_;
+
+    int fingerBits_;            // b: fingers fix base-2^b digits
+    int pnsCandidates_;         // 1 means the plain successor
+    RouteSelection routeSelection_;
+    double prsHopWeight_;       // weight of the expected remaining hops
+
+    double fingerRttSum_;       // sum of the estimated RTTs to our fingers
+    int numFingerRtts_;         // and their number
+    long prsDetours_;           // lookups sent to a finger other than the closest one
+};
+
+#endif /* CS6381_CHORD_P2P_CHORDROUTINGTABLE_H_ */
@@ -0,0 +1,215 @@
+/*
+ * ChurnDriver.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstdint>
+using namespace std;
+
+#include "ChurnDriver.h"     // our header
+#include "ChordNode.h"
+
+// register the module with Omnet++
+Define_Module(ChurnDriver);
+
+simsignal_t ChurnDriver::sentLookupSignal = registerSignal("sentLookupTS");
+simsignal_t ChurnDriver::rcvdRespSignal = registerSignal("rcvdRespTS");
+simsignal_t ChurnDriver::lookupFailedSignal = registerSignal("lookupFailed");
+simsignal_t ChurnDriver::lookupMisroutedSignal = registerSignal("lookupMisrouted");
+simsignal_t ChurnDriver::maintenanceBytesSignal = registerSignal("maintenanceBytes");
+simsignal_t ChurnDriver::liveHostsSignal = registerSignal("liveHosts");
+
+ChurnDriver::ChurnDriver (void)
+    : cSimpleModule (),
+      cListener (),
+      helper_ (nullptr),
+      crashFraction_ (0.0),
+      minLiveHosts_ (1),
+      reportInterval_ (),
+      timers_ (),
+      reportTimer_ (nullptr),
+      leaves_ (0),
+      crashes_ (0),
+      joins_ (0),
+      sentAt_ (),
+      windowAnswered_ (0),
+      windowFailed_ (0),
+      windowMisrouted_ (0),
+      windowLatencySum_ (0.0),
+      windowMaintenanceBytes_ (0),
+      totalAnswered_ (0),
+      totalFailed_ (0),
+      successRateVector_ ("lookupSuccessRate"),
+      latencyVector_ ("lookupLatency"),
+      misroutedVector_ ("lookupsMisrouted"),
+      maintenanceVector_ ("maintenanceBytes")
+{
+}
+
+ChurnDriver::~ChurnDriver (void)
+{
+    for (vector<cMessage *>::iterator it = this->timers_.begin (); it != this->timers_.end (); ++it)
+        cancelAndDelete (*it);
+    cancelAndDelete (this->reportTimer_);
+    if (this->helper_)
+        Helper::release ();
+}
+
+void ChurnDriver::initialize (void)
+{
+    this->helper_ = Helper::acquire ();
+    if (this->helper_->num_partitions () > 1)
+        throw cRuntimeError ("ChurnDriver::initialize -- churn is not supported in parallel runs");
+
+    this->crashFraction_ = this->par ("crashFraction").doubleValue ();
+    this->minLiveHosts_ = this->par ("minLiveHosts").longValue ();
+    if (this->minLiveHosts_ < 1)
+        throw cRuntimeError ("ChurnDriver::initialize -- minLiveHosts must be at least 1, not %d", this->minLiveHosts_);
+    this->reportInterval_ = this->par ("reportInterval").doubleValue ();
+    this->helper_->enable_churn ();
+
+    // every host starts out on the ring with a session of its own
+    simtime_t start = this->par ("startTime").doubleValue ();
+    for (int h = 0; h < this->helper_->num_chord_nodes (); ++h) {
+        cMessage *timer = new cMessage ("leave", ChurnDriver::LEAVE);
+        timer->setContextPointer ((void *) (intptr_t) h);
+        this->scheduleAt (start + this->par ("sessionTime").doubleValue (), timer);
+        this->timers_.push_back (timer);
+    }
+
+    this->reportTimer_ = new cMessage ("churn_report", ChurnDriver::REPORT);
+    this->scheduleAt (simTime () + this->reportInterval_, this->reportTimer_);
+
+    // the signals of clients and chord nodes reach us through the network
+    cModule *network = getSimulation ()->getSystemModule ();
+    network->subscribe (ChurnDriver::sentLookupSignal, this);
+    network->subscribe (ChurnDriver::rcvdRespSignal, this);
+    network->subscribe (ChurnDriver::lookupFailedSignal, this);
+    network->subscribe (ChurnDriver::lookupMisroutedSignal, this);
+    network->subscribe (ChurnDriver::maintenanceBytesSignal, this);
+
+    this->emit (ChurnDriver::liveHostsSignal, (long) this->helper_->num_live_hosts ());
+}
+
+void ChurnDriver::handleMessage (cMessage *msg)
+{
+    if (msg->getKind () == ChurnDriver::REPORT) {
+        this->report ();
+        this->scheduleAt (simTime () + this->reportInterval_, msg);
+        return;
+    }
+
+    int h = (int) (intptr_t) msg->getContextPointer ();
+    if (msg->getKind () == ChurnDriver::LEAVE)
+        this->host_leave (h, msg);
+    else
+        this->host_join (h, msg);
+}
+
+void ChurnDriver::finish (void)
+{
+    this->report ();
+
+    recordScalar ("hostLeaves", this->leaves_);
+    recordScalar ("hostCrashes", this->crashes_);
+    recordScalar ("hostJoins", this->joins_);
+    recordScalar ("liveHostsAtEnd", this->helper_->num_live_hosts ());
+    long total = this->totalAnswered_ + this->totalFailed_;
+    recordScalar ("lookupSuccessRate", (total > 0) ? (double) this->totalAnswered_ / total : 1.0);
+}
+
+ChordNode *ChurnDriver::chord_node (int hostIndex)
+{
+    int id = this->helper_->endpoint_module (hostIndex);
+    cModule *mod = (id >= 0) ? getSimulation ()->getModule (id) : nullptr;
+    if (!mod)
+        throw cRuntimeError ("ChurnDriver::chord_node -- no chord node for host %d", hostIndex);
+    return check_and_cast<ChordNode *> (mod);
+}
+
+void ChurnDriver::host_leave (int hostIndex, cMessage *timer)
+{
+    // keep a ring to leave, or the host gets another session instead
+    if (this->helper_->num_live_hosts () <= this->minLiveHosts_) {
+        this->scheduleAt (simTime () + this->par ("sessionTime").doubleValue (), timer);
+        return;
+    }
+
+    bool crash = uniform (0.0, 1.0) < this->crashFraction_;
+    EV << "=== ChurnDriver::host_leave: host " << hostIndex
+       << (crash ? " crashes" : " leaves") << endl;
+
+    // the ring goes on without the host before it hands its keys over, so
+    // that they go to their owners on the ring it leaves behind
+    this->helper_->set_host_up (hostIndex, false);
+    this->chord_node (hostIndex)->leave (!crash);
+    if (crash)
+        this->crashes_++;
+    else
+        this->leaves_++;
+    this->emit (ChurnDriver::liveHostsSignal, (long) this->helper_->num_live_hosts ());
+
+    timer->setKind (ChurnDriver::JOIN);
+    timer->setName ("join");
+    this->scheduleAt (simTime () + this->par ("downTime").doubleValue (), timer);
+}
+
+void ChurnDriver::host_join (int hostIndex, cMessage *timer)
+{
+    EV << "=== ChurnDriver::host_join: host " << hostIndex << " comes back" << endl;
+
+    this->helper_->set_host_up (hostIndex, true);
+    this->chord_node (hostIndex)->join ();
+    this->joins_++;
+    this->emit (ChurnDriver::liveHostsSignal, (long) this->helper_->num_live_hosts ());
+
+    timer->setKind (ChurnDriver::LEAVE);
+    timer->setName ("leave");
+    this->scheduleAt (simTime () + this->par ("sessionTime").doubleValue (), timer);
+}
+
+void ChurnDriver::report (void)
+{
+    long done = this->windowAnswered_ + this->windowFailed_;
+    if (done > 0)
+        this->successRateVector_.record ((double) this->windowAnswered_ / done);
+    if (this->windowAnswered_ > 0)
+        this->latencyVector_.record (this->windowLatencySum_ / this->windowAnswered_);
+    this->misroutedVector_.record (this->windowMisrouted_);
+    this->maintenanceVector_.record (this->windowMaintenanceBytes_);
+
+    this->totalAnswered_ += this->windowAnswered_;
+    this->totalFailed_ += this->windowFailed_;
+    this->windowAnswered_ = 0;
+    this->windowFailed_ = 0;
+    this->windowMisrouted_ = 0;
+    this->windowLatencySum_ = 0.0;
+    this->windowMaintenanceBytes_ = 0;
+}
+
+void ChurnDriver::receiveSignal (cComponent *source, simsignal_t signalID, const SimTime &t, cObject *details)
+{
+    // a client has one request outstanding at a time
+    if (signalID == ChurnDriver::sentLookupSignal) {
+        this->sentAt_[source] = t;
+    } else if (signalID == ChurnDriver::rcvdRespSignal) {
+        map<cComponent *, simtime_t>::iterator it = this->sentAt_.find (source);
+        if (it != this->sentAt_.end ()) {
+            this->windowLatencySum_ += (t - it->second).dbl ();
+            this->sentAt_.erase (it);
+        }
+        this->windowAnswered_++;
+    } else if (signalID == ChurnDriver::lookupFailedSignal) {
+        this->sentAt_.erase (source);
+        this->windowFailed_++;
+    }
+}
+
+void ChurnDriver::receiveSignal (cComponent *source, simsignal_t signalID, long l, cObject *details)
+{
+    if (signalID == ChurnDriver::maintenanceBytesSignal)
+        this->windowMaintenanceBytes_ += l;
+    else if (signalID == ChurnDriver::lookupMisroutedSignal)
+        this->windowMisrouted_++;
+}
@@ -0,0 +1,100 @@
+/*
+ * ChurnDriver.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_CHURNDRIVER_H_
+#define CS6381_CHORD_P2P_CHURNDRIVER_H_
+
+#include <map>
+#include <vector>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+#include "Helper.h"
+
+class ChordNode;
+
+/**
+ * Makes the chord hosts leave the ring and come back. Every host alternates
+ * between sessions on the ring and times off it, drawn from the sessionTime
+ * and downTime parameters (any NED distribution, e.g. exponential,
+ * pareto_shifted or weibull). A leave is a crash with probability
+ * crashFraction and graceful otherwise.
+ *
+ * Every reportInterval the driver records how the ring fared: the hosts on
+ * it, the share of the lookups answered (rather than given up on), their
+ * mean latency, the lookups answered by a node other than the owner of the
+ * key, and the stabilization and key hand-over traffic of the chord nodes.
+ *
+ * Churn needs the overlay or the UDP transport; the clients must time out
+ * (UDP, or overlayRetransmit) and the chord nodes must stabilize
+ * (stabilizeInterval) for the ring to recover.
+ */
+class ChurnDriver : public cSimpleModule, public cListener
+{
+public:
+    ChurnDriver (void);
+    virtual ~ChurnDriver (void);
+
+protected:
+    virtual void initialize (void) override;
+    virtual void handleMessage (cMessage *msg) override;
+    virtual void finish (void) override;
+
+    virtual void receiveSignal (cComponent *source, simsignal_t signalID, const SimTime &t, cObject *details) override;
+    virtual void receiveSignal (cComponent *source, simsignal_t signalID, long l, cObject *details) override;
+
+private:
+    // what each host timer stands for
+    enum { LEAVE = 0, JOIN = 1, REPORT = 2 };
+
+    // the chord node of a host
+    ChordNode *chord_node (int hostIndex);
+
+    // take a host off the ring, or put it back
+    void host_leave (int hostIndex, cMessage *timer);
+    void host_join (int hostIndex, cMessage *timer);
+
+    // close the reporting window
+    void report (void);
+
+    static simsignal_t sentLookupSignal;
+    static simsignal_t rcvdRespSignal;
+    static simsignal_t lookupFailedSignal;
+    static simsignal_t lookupMisroutedSignal;
+    static simsignal_t maintenanceBytesSignal;
+    static simsignal_t liveHostsSignal;
+
+    Helper *helper_;
+    double crashFraction_;      // leaves that are crashes
+    int minLiveHosts_;          // the ring never shrinks below this
+    simtime_t reportInterval_;
+
+    vector<cMessage *> timers_; // leave or join timer of every host
+    cMessage *reportTimer_;
+
+    long leaves_;               // graceful leaves
+    long crashes_;
+    long joins_;
+
+    // the current reporting window, and totals since churn started
+    map<cComponent *, simtime_t> sentAt_;   // outstanding request of every client
+    long windowAnswered_;
+    long windowFailed_;
+    long windowMisrouted_;
+    double windowLatencySum_;
+    long windowMaintenanceBytes_;
+    long totalAnswered_;
+    long totalFailed_;
+
+    cOutVector successRateVector_;
+    cOutVector latencyVector_;
+    cOutVector misroutedVector_;
+    cOutVector maintenanceVector_;
+};
+
+#endif /* CS6381_CHORD_P2P_CHURNDRIVER_H_ */
@@ -8,6 +8,7 @@
  *      Institution: Vanderbilt University
  */
 
+#include <cmath>
 #include <random>
 using namespace std;
 
@@ -16,6 +17,7 @@ using namespace std;
 
 #include "inet/common/INETEndians.h"  // for host/network byte ordering
 #include "inet/networklayer/common/L3AddressResolver.h" // address resolution
+#include "inet/transportlayer/contract/udp/UDPControlInfo_m.h" // UDP indications
 using namespace inet;
 
 #include "Helper.h"
@@ -25,25 +27,66 @@ Define_Module(Client);
 
 simsignal_t Client::sentLookupSignal = registerSignal("sentLookupTS");
 simsignal_t Client::rcvdRespSignal = registerSignal("rcvdRespTS");
+simsignal_t Client::hopCountSignal = registerSignal("hopCount");
+simsignal_t Client::hopTimeSignal = registerSignal("hopTime");
+simsignal_t Client::connSetupTimeSignal = registerSignal("connSetupTime");
+simsignal_t Client::lookupQueueTimeSignal = registerSignal("lookupQueueTime");
+simsignal_t Client::rpcRetransmissionsSignal = registerSignal("rpcRetransmissions");
+simsignal_t Client::lookupFailedSignal = registerSignal("lookupFailed");
+simsignal_t Client::lookupMisroutedSignal = registerSignal("lookupMisrouted");
 
 // constructor and destructor
 Client::Client (void)
     : cSimpleModule (),
+      helper_ (nullptr),
       myID_ (),
       chordNodePort_ (10000),
       numItersPerLookup_ (1),
-      nodeList_ (),
+      nodeList_ (nullptr),
       lookupKeys_ (),
       socket_ (nullptr),
+      transport_ (Helper::TCP),
+      latency_ (nullptr),
+      gateway_ (nullptr),
+      address_ (-1),
+      entryAddress_ (-1),
+      udpSocket_ (),
+      entryAddr_ (),
+      retransmit_ (false),
+      rpcTimeout_ (),
+      rpcMaxRetries_ (0),
+      rpcBackoff_ (1.0),
+      seq_ (0),
+      retries_ (0),
+      rpcTimer_ (nullptr),
+      getFraction_ (0.0),
+      putFraction_ (0.0),
+      deleteFraction_ (0.0),
+      op_ (0),
+      valueSize_ (0),
+      kvGets_ (0),
+      kvGetHits_ (0),
+      kvPuts_ (0),
+      kvDeletes_ (0),
+      kvReplicaReads_ (0),
+      verifyLookups_ (false),
+      failOnMisroute_ (false),
+      lookupsVerified_ (0),
+      lookupsMisrouted_ (0),
+      trace_ (),
+      vivaldi_ (),
+      entryCandidates_ (1),
       currIter_ (0),
-      nextKeyIndex_ (0)
+      nextKeyIndex_ (0),
+      connectStartedAt_ ()
 {
     // nothing
 }
 
 Client::~Client()
 {
-    // nothing
+    if (this->helper_)
+        Helper::release ();
 }
 
 // the initialize method invoked by the simulator during initialization stages
@@ -63,11 +106,65 @@ void Client::initialize (int stage)
                 + std::to_string (this->getParentModule()->getId ());
 
     this->chordNodePort_ = this->par ("chordNodePort");
+    this->getFraction_ = this->par ("getFraction").doubleValue ();
+    this->putFraction_ = this->par ("putFraction").doubleValue ();
+    this->deleteFraction_ = this->par ("deleteFraction").doubleValue ();
+    if (this->getFraction_ < 0 || this->putFraction_ < 0 || this->deleteFraction_ < 0
+            || this->getFraction_ + this->putFraction_ + this->deleteFraction_ > 1.0)
+        throw cRuntimeError ("Client::initialize -- the get, put and delete fractions must add up to at most 1");
+    this->verifyLookups_ = this->par ("verifyLookups").boolValue ();
+    this->failOnMisroute_ = this->par ("failOnMisroute").boolValue ();
+    this->trace_.open (this, this->par ("traceLevel").longValue (),
+                       this->par ("traceFile").stdstringValue (),
+                       this->par ("traceBufferSize").longValue (),
+                       this->par ("traceWrap").boolValue ());
+    if (this->par ("vivaldi").boolValue ()) {
+        this->vivaldi_.init (this->par ("vivaldiDimensions").longValue (), this->par ("vivaldiCc").doubleValue (),
+                             this->par ("vivaldiCe").doubleValue (), getRNG (0));
+        this->entryCandidates_ = this->par ("entryCandidates").longValue ();
+    }
+    this->transport_ = Helper::parse_transport (this->par ("transport").stdstringValue ());
+    this->helper_ = Helper::acquire ();
+    if (this->transport_ == Helper::UDP) {
+        if (!gate ("udpOut")->isConnected ())
+            throw cRuntimeError ("Client::initialize -- the UDP transport needs us in the host's udpApp[] "
+                                 "(set the host's transport parameter too)");
+        this->udpSocket_.setOutputGate (gate ("udpOut"));
+        this->udpSocket_.bind (this->par ("localPort").longValue ());
+    }
+    this->retransmit_ = (this->transport_ == Helper::UDP)
+                        || (this->transport_ == Helper::OVERLAY && this->par ("overlayRetransmit").boolValue ());
+    if (this->retransmit_) {
+        this->rpcTimeout_ = this->par ("rpcTimeout").doubleValue ();
+        this->rpcMaxRetries_ = this->par ("rpcMaxRetries").longValue ();
+        this->rpcBackoff_ = this->par ("rpcBackoff").doubleValue ();
+        this->rpcTimer_ = new cMessage ("rpc_timeout", 2);
+    }
+    if (this->transport_ == Helper::OVERLAY) {
+        this->latency_ = LatencyModel::local (this->par ("latencyModel").stringValue ());
+        if (!this->latency_)
+            throw cRuntimeError ("Client::initialize -- overlay transport needs a LatencyModel module \"%s\"",
+                                 this->par ("latencyModel").stringValue ());
+        this->gateway_ = OverlayGateway::local (this->par ("overlayGateway").stringValue ());
+        if (!this->gateway_)
+            throw cRuntimeError ("Client::initialize -- overlay transport needs an OverlayGateway module \"%s\"",
+                                 this->par ("overlayGateway").stringValue ());
+
+        // clients have the addresses after the chord hosts'. We report to the
+        // coordinator through signals, which do not cross partitions, so we
+        // must be in its partition (0).
+        this->address_ = this->helper_->client_address (this->getParentModule()->getIndex ());
+        if (this->helper_->partition_of (this->address_) != getSimulation ()->getParsimProcId ())
+            throw cRuntimeError ("Client::initialize -- clients must be in partition %d, not %d",
+                                 this->helper_->partition_of (this->address_),
+                                 getSimulation ()->getParsimProcId ());
+        this->helper_->register_endpoint (this->address_, this->getId ());
+    }
 
     // retrieve various parameters from the helper
-    this->numItersPerLookup_ = helper->num_iters_per_lookup ();
-    helper->chord_node_list (this->nodeList_);
-    helper->gen_lookup_keys (this->lookupKeys_);
+    this->numItersPerLookup_ = this->helper_->num_iters_per_lookup ();
+    this->nodeList_ = &this->helper_->chord_node_list ();
+    this->helper_->gen_lookup_keys (this->lookupKeys_);
 
     EV << "=== Client::initialize"
        << "\tmyID_ = " << this->myID_ << endl
@@ -98,15 +195,24 @@ void Client::initialize (int stage)
 /** the all-purpose "handle message" method where we need to decide what action we would like to take */
 void Client::handleMessage (cMessage *msg)
 {
-    EV << "=== Client::handleMessage " << this->myID_
-       << " received handleMessage message" << endl;
-
     // check if this is a timer message generated the first time to wake us up
     // and start conversation with the server (or a subsequent timer)
     if (msg->isSelfMessage ()) // this is how we check it because we generated
                                // it for ourselves.
         this->handleTimer (msg);
-    else {
+    else if (this->transport_ == Helper::OVERLAY) {
+        // the overlay transport delivers the response itself
+        this->socketDataArrived (-1, nullptr, check_and_cast<cPacket *> (msg), false);
+    } else if (this->transport_ == Helper::UDP) {
+        // a datagram, or an ICMP error that the retransmission timer covers
+        if (msg->getKind () != UDP_I_DATA) {
+            CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_UDP_INDICATION, msg->getKind (), 0);
+            delete msg;
+            return;
+        }
+        delete msg->removeControlInfo ();
+        this->socketDataArrived (-1, nullptr, check_and_cast<cPacket *> (msg), false);
+    } else {
         if (!this->socket_) {
             // socket was not initialized for some reason. Why?
             throw cRuntimeError("Client::handleMessage -- socket does not exist");
@@ -128,9 +234,34 @@ void Client::finish ()
 {
     EV << "=== Client::finish called" << endl;
 
+    if (this->kvGets_ + this->kvPuts_ + this->kvDeletes_ > 0) {
+        recordScalar ("kvGets", this->kvGets_);
+        recordScalar ("kvGetHits", this->kvGetHits_);
+        recordScalar ("kvPuts", this->kvPuts_);
+        recordScalar ("kvDeletes", this->kvDeletes_);
+        recordScalar ("kvReplicaReads", this->kvReplicaReads_);
+    }
+    if (this->verifyLookups_) {
+        recordScalar ("lookupsVerified", this->lookupsVerified_);
+        recordScalar ("lookupsMisrouted", this->lookupsMisrouted_);
+    }
+    if (this->vivaldi_.enabled ()) {
+        recordScalar ("vivaldiSamples", this->vivaldi_.num_samples ());
+        recordScalar ("vivaldiKnownHosts", this->vivaldi_.num_known ());
+        recordScalar ("vivaldiSampleError", this->vivaldi_.mean_sample_error ());
+    }
+    if (this->trace_.enabled (TRACE_LOOKUP)) {
+        recordScalar ("traceRecords", this->trace_.num_records ());
+        recordScalar ("traceOverwritten", this->trace_.num_overwritten ());
+    }
+    this->trace_.close ();
+
     // cleanup the socket
     delete this->socket_;
     this->socket_ = nullptr;
+
+    cancelAndDelete (this->rpcTimer_);
+    this->rpcTimer_ = nullptr;
 }
 
 /** handle the timeout method */
@@ -141,10 +272,13 @@ void Client::handleTimer (cMessage *msg)
     //
     // Thus, kind == 0 => timer for making a connection
     //       kind == 1 => timer for next iteration on the same connection
+    //       kind == 2 => retransmission timer of the UDP transport
     //       anything else is an exception
-    if (msg->getKind() == 0) {
-        EV << "@" << simTime () << " ,=== Client::handleTimer " << this->myID_
-                << " being kickstarted to start a connection ===" << endl;
+    if (msg->getKind() == 2) {
+        // this timer is ours to reuse, so it is not deleted
+        this->rpc_timeout ();
+        return;
+    } else if (msg->getKind() == 0) {
         setStatusString ("connecting");
 
         // here our aim is to send a lookup request. So first we must connect
@@ -156,16 +290,20 @@ void Client::handleTimer (cMessage *msg)
 
         // make sure that we still have more lookups pending
         if (this->nextKeyIndex_ < this->lookupKeys_.size()) {
-            // select a node at random from the list.
-            std::mt19937 generator (1 << helper->num_bits()); // mersenne_twister_engine random num generator
-            int nodeIndex = generator () % helper->num_chord_nodes();
+            // select a node from the list: with coordinates the closest of a
+            // few, otherwise at random
+            int nodeIndex;
+            if (this->vivaldi_.enabled ()) {
+                nodeIndex = this->pick_entry ();
+            } else {
+                std::mt19937 generator ((std::mt19937::result_type) this->helper_->key_space ()); // mersenne_twister_engine random num generator
+                nodeIndex = generator () % this->nodeList_->size ();
+            }
 
             // connect to this node
             this->connect (nodeIndex);
         }
     } else if (msg->getKind() == 1) {
-        EV << "@" << simTime () << " ,=== Client::handleTimer " << this->myID_
-                << " being kickstarted to send next iteration ===" << endl;
         setStatusString ("next iteration");
 
         // here our aim is to send the same lookup request to the same chord node
@@ -188,12 +326,13 @@ void Client::handleTimer (cMessage *msg)
 // this method is invoked when the connection is established
 void Client::socketEstablished (int connID, void *role)
 {
-    EV << "=== Client::socketEstablished " << this->myID_
-       << " received socketEstablished message on connID "
-       << connID << " ===" << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_ESTABLISHED, connID, 0);
 
     this->setStatusString("ConnectionEstablished");
 
+    // time it took to set up the connection to the chord node
+    this->emit (Client::connSetupTimeSignal, simTime () - this->connectStartedAt_);
+
     // Now that the connection is established, we initiate the lookup request to the server
     this->sendRequest ();
 }
@@ -204,12 +343,7 @@ void Client::socketDataArrived(int connID, void *, cPacket *msg, bool)
     // debugging output
     setStatusString ("Response");
 
-    EV << "=== Client::socketDataArrived " << this->myID_
-       << " received socketDataArrived message on connID " << connID
-       << " of byte length = " << msg->getByteLength ()
-       << " ===" << endl;
-
-    this->emit (Client::rcvdRespSignal, simTime ());
+    CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_MSG_ARRIVED, connID, msg->getByteLength ());
 
     // incoming request ought to be Response packet.
     Lookup_Resp *resp = dynamic_cast<Lookup_Resp *> (msg);
@@ -218,18 +352,93 @@ void Client::socketDataArrived(int connID, void *, cPacket *msg, bool)
         return;
     }
 
-    // print the details
-    EV << "**** Client: Arriving packet: Lookup_Resp " << endl;
-    EV << "\tLookup key = " << resp->getKey() << endl;
-    EV << "\tsender = " << resp->getSender() << endl;
-    EV << "\tNum of responders = " << resp->getResponderArraySize() << endl;
-    for (int i=0; i < resp->getResponderArraySize(); ++i) {
-        EV << "\t\tresponder[" << i << "] = " << resp->getResponder (i) << endl;
+    // with retransmissions, a request may be answered more than once, and
+    // a late answer may come in after we gave up on it
+    if (this->retransmit_) {
+        if (resp->getSeq () != this->seq_ || !this->rpcTimer_->isScheduled ()) {
+            CHORD_TRACE (this->trace_, TRACE_MESSAGE, TRACE_RESP_LATE, resp->getKey (), resp->getSeq ());
+            delete resp;
+            return;
+        }
+        cancelEvent (this->rpcTimer_);
+        this->emit (Client::rpcRetransmissionsSignal, (long) this->retries_);
+    }
+
+    this->emit (Client::rcvdRespSignal, simTime ());
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_RESP_ARRIVED, resp->getKey (), resp->getHopCount ());
+
+    // the per hop breakdown travels with the response: the number of chord
+    // hops the request took, the time spent waiting inside chord nodes, and
+    // the transit time of the last hop back to us
+    this->emit (Client::hopCountSignal, (long) resp->getHopCount ());
+    this->emit (Client::lookupQueueTimeSignal, resp->getQueuedTime ());
+    this->emit (Client::hopTimeSignal, simTime () - resp->getHopSentTS ());
+
+    // the answer tells us where the entry node is, and times the round trip
+    // to it: it echoes when we sent the request and says how long the node
+    // held it. It also tells us where the node that answered is.
+    if (this->vivaldi_.enabled () && resp->getSrcAddress () >= 0) {
+        if (resp->getEchoTS () >= SIMTIME_ZERO)
+            this->vivaldi_.sample (resp->getSrcAddress (), simTime () - resp->getEchoTS () - resp->getEchoHeld (),
+                                   Vivaldi::read (resp), resp->getCoordError ());
+        Vivaldi::Coord responder (resp->getResponderCoordArraySize ());
+        for (size_t i = 0; i < responder.size (); ++i)
+            responder[i] = resp->getResponderCoord (i);
+        this->vivaldi_.learn (this->helper_->node_host (strtoll (resp->getSender (), nullptr, 10)),
+                              responder, resp->getResponderCoordError ());
+    }
+    if (this->verifyLookups_)
+        this->verify_response (resp);
+
+    // the outcome of a store operation
+    KV_Resp *kv = dynamic_cast<KV_Resp *> (resp);
+    if (kv) {
+        if (kv->getOp () == KV_GET) {
+            this->kvGets_++;
+            if (kv->getFound ())
+                this->kvGetHits_++;
+            if (kv->getReplica ())
+                this->kvReplicaReads_++;
+        } else if (kv->getOp () == KV_PUT) {
+            this->kvPuts_++;
+        } else {
+            this->kvDeletes_++;
+        }
     }
 
     // cleanup the response message
     delete resp;
 
+    this->lookup_done ();
+}
+
+/** check that the answer came from the owner of the key */
+void Client::verify_response (Lookup_Resp *resp)
+{
+    // The owner is the successor of the key on the ring, which the helper
+    // knows. A get answered by a replica comes from another node on purpose;
+    // those we leave alone.
+    KV_Resp *kv = dynamic_cast<KV_Resp *> (resp);
+    if (kv && kv->getReplica ())
+        return;
+
+    Helper::NodeID key = this->lookupKeys_[this->nextKeyIndex_];
+    Helper::NodeID owner = this->helper_->key_owner (key);
+    this->lookupsVerified_++;
+    if (resp->getKey () == key && strtoll (resp->getSender (), nullptr, 10) == owner)
+        return;
+
+    this->lookupsMisrouted_++;
+    this->emit (Client::lookupMisroutedSignal, (long) key);
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_MISROUTED, key, strtoll (resp->getSender (), nullptr, 10));
+    if (this->failOnMisroute_)
+        throw cRuntimeError ("Client::verify_response -- key %lld answered by node %s, its owner is %lld",
+                             (long long) key, resp->getSender (), (long long) owner);
+}
+
+/** one iteration of a lookup is over, answered or not: move on */
+void Client::lookup_done (void)
+{
     // increment the iterations for this request
     this->currIter_++;
 
@@ -252,7 +461,7 @@ void Client::socketDataArrived(int connID, void *, cPacket *msg, bool)
         // Just start a new timer and let the system handle the sending of the next request
         cMessage *timer_msg = new cMessage ("next_iter", 1);
         if (!timer_msg) {
-            throw cRuntimeError("Client::socketDataArrived -- no memory for timer");
+            throw cRuntimeError("Client::lookup_done -- no memory for timer");
             return;
         }
         this->scheduleAt (simTime () + exponential (5), timer_msg);
@@ -262,9 +471,7 @@ void Client::socketDataArrived(int connID, void *, cPacket *msg, bool)
 // we closed the socket and got notified
 void Client::socketClosed (int connID, void *)
 {
-    EV << "=== Client::socketClosed " << this->myID_
-       << " received socketClosed message on connID " << connID
-       << " ===" << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_CLOSED, connID, 0);
 
     setStatusString("socket closed");
 
@@ -278,10 +485,6 @@ void Client::socketClosed (int connID, void *)
     if (this->nextKeyIndex_ < this->lookupKeys_.size()) {
         // now we start a timer so that when it kicks in, we make a connection
         // to server 
-        EV << "=== Client::socketClosed "
-           << " still more requests to send. So start a new timer for new lookup request."
-           << endl;
-        
         cMessage *timer_msg = new cMessage ("connect", 0);
         if (!timer_msg) {
             throw cRuntimeError("Client::socketClosed -- no memory for timer");
@@ -294,9 +497,7 @@ void Client::socketClosed (int connID, void *)
 // peer closed the socket
 void Client::socketPeerClosed (int connID, void *)
 {
-    EV << "=== Client::socketPeerClosed " << this->myID_
-       << " received socketPeerClosed message on connID "
-       << connID << " ===" << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_CLOSED, connID, 1);
     setStatusString("peer socket closed");
 
 }
@@ -304,9 +505,7 @@ void Client::socketPeerClosed (int connID, void *)
 // something failed with sockets
 void Client::socketFailure (int connID, void *, int code)
 {
-    EV << "=== Client::socketFailure " << this->myID_
-       << " received socketFailure message on connID " << connID
-       << " with failure code = " << code << " ===" << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_SOCKET_FAILED, connID, code);
 
     setStatusString("connection broken");
 
@@ -318,15 +517,48 @@ void Client::socketFailure (int connID, void *, int code)
 /**           helper methods                                          */
 /**********************************************************************/
 
+// the chord node a lookup goes to
+int Client::pick_entry (void)
+{
+    // any node will do; with coordinates, the one of lowest predicted RTT of
+    // a few. A candidate we know nothing of yet loses to any we do, but as
+    // the candidates are drawn afresh for every lookup we get to know more
+    // of them.
+    int best = intuniform (0, this->nodeList_->size () - 1);
+    if (!this->vivaldi_.enabled ())
+        return best;
+    simtime_t bestRtt = this->vivaldi_.predict (this->helper_->node_host ((*this->nodeList_)[best]));
+    for (int k = 1; k < this->entryCandidates_; ++k) {
+        int c = intuniform (0, this->nodeList_->size () - 1);
+        simtime_t rtt = this->vivaldi_.predict (this->helper_->node_host ((*this->nodeList_)[c]));
+        if (rtt >= SIMTIME_ZERO && (bestRtt < SIMTIME_ZERO || rtt < bestRtt)) {
+            best = c;
+            bestRtt = rtt;
+        }
+    }
+    return best;
+}
+
 // you may need to change the signature of this method to pass the chord node's addr as param
 // this method establishes a connection to the server.
 void Client::connect (int nodeIdx)
 {
     // what we receive is an index into the node list
-    EV << "=== Client::connect " << this->myID_
-       << " connect to the chord node with ID"
-       << this->nodeList_[nodeIdx] << " ======= " << endl;
-    
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_CONNECT, (*this->nodeList_)[nodeIdx], 0);
+
+    // the overlay and UDP transports have no connection to set up: we just
+    // remember where the node is and send it the request right away
+    if (this->transport_ == Helper::OVERLAY) {
+        this->entryAddress_ = this->helper_->node_host ((*this->nodeList_)[nodeIdx]);
+        this->sendRequest ();
+        return;
+    }
+    if (this->transport_ == Helper::UDP) {
+        this->entryAddr_ = this->helper_->lookup_node ((*this->nodeList_)[nodeIdx]);
+        this->sendRequest ();
+        return;
+    }
+
     // create a new socket in the connecting role. Note that there should not
     // be an existing socket. If there is one, clean it up
 
@@ -363,51 +595,132 @@ void Client::connect (int nodeIdx)
 
     // Hint: see helper class' API to get the address of the node we are interested in
 
-    inet::L3Address addr = helper->lookup_node (this->nodeList_[nodeIdx]);
-    EV << "=== client::connect: address of node ID " << this->nodeList_[nodeIdx]
-       << " = " << addr.str () << endl;
-
+    inet::L3Address addr = this->helper_->lookup_node ((*this->nodeList_)[nodeIdx]);
     this->socket_->connect (addr, this->chordNodePort_);
+    this->connectStartedAt_ = simTime ();
 
-    // debugging
-    EV << "+++ Client: " << this->myID_ << " created a new socket with "
-       << "connection ID = " << this->socket_->getConnectionId ()
-       << " +++" << endl;
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_CONNECT_STARTED, this->socket_->getConnectionId (), 0);
 }
 
 // close the peer side. This is invoked by the client when it has received a
 // response to what it requested.
 void Client::close()
 {
-    EV << "=== Client::close -- " << this->myID_
-       << " close the connection to the server " << endl;
-    
     setStatusString("closing");
+
+    // nothing to close without a connection; move on to the next lookup
+    if (this->transport_ != Helper::TCP) {
+        this->socketClosed (-1, nullptr);
+        return;
+    }
     this->socket_->close ();
 }
 
 // send a request to the other side
 void Client::sendRequest (void)
 {
-    // populate a request packet with the details and send it
-    // don't forget to start the round trip measurement timer
+    // a new request; its retransmissions (UDP) keep the sequence number
+    // and the operation
+    this->seq_++;
+    this->retries_ = 0;
+
+    double u = uniform (0.0, 1.0);
+    if (u < this->putFraction_) {
+        this->op_ = KV_PUT;
+        this->valueSize_ = this->par ("valueSize").longValue ();
+    } else if (u < this->putFraction_ + this->getFraction_) {
+        this->op_ = KV_GET;
+    } else if (u < this->putFraction_ + this->getFraction_ + this->deleteFraction_) {
+        this->op_ = KV_DELETE;
+    } else {
+        this->op_ = 0;
+    }
 
-    Lookup_Req  *request = new Lookup_Req ();
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_REQUEST_SENT,
+                 this->lookupKeys_[this->nextKeyIndex_], this->seq_);
+
+    // start the measurement of round trip delay. It covers any
+    // retransmissions too.
+    this->emit (Client::sentLookupSignal, simTime ());
+
+    this->transmit_request ();
+}
+
+// (re)transmit the outstanding request
+void Client::transmit_request (void)
+{
+    // populate a request packet with the details and send it. A put
+    // carries its value.
+    Lookup_Req  *request;
+    if (this->op_ == KV_PUT) {
+        Put_Req *put = new Put_Req ();
+        put->setValueSize (this->valueSize_);
+        request = put;
+    } else if (this->op_ == KV_GET) {
+        request = new Get_Req ();
+    } else if (this->op_ == KV_DELETE) {
+        request = new Delete_Req ();
+    } else {
+        request = new Lookup_Req ();
+    }
     request->setKey (this->lookupKeys_[this->nextKeyIndex_]);
     request->setSender (this->myID_.c_str ());
-    request->setByteLength (sizeof (int) + this->myID_.length() + 1);
+    request->setSeq (this->seq_);
+    request->setHopCount (0);
+    request->setQueuedTime (SIMTIME_ZERO);
+    request->setByteLength (sizeof (int) + this->myID_.length() + 1
+                            + 2 * sizeof (int) + 2 * sizeof (int64_t));
+    if (this->op_ == KV_PUT)
+        request->addByteLength (sizeof (int) + this->valueSize_);
 
-    EV << "=== Client::sendRequest " << this->myID_
-        << " making lookup request for key: "
-        << request->getKey () << endl;
+    // send to the chord node to whom we are connected
+    request->setHopSentTS (simTime ());
+    if (this->transport_ == Helper::UDP) {
+        this->udpSocket_.sendTo (request, this->entryAddr_, this->chordNodePort_);
+    } else if (this->transport_ == Helper::OVERLAY) {
+        request->setSrcAddress (this->address_);
+        simtime_t delay = this->latency_->delay (this->address_, this->entryAddress_,
+                                                 request->getByteLength ());
+        this->gateway_->deliver (request, this->entryAddress_, delay);
+    } else {
+        this->socket_->send (request);
+    }
 
-    // start the measurement of round trip delay
-    this->emit (Client::sentLookupSignal, simTime ());
+    if (this->retransmit_) {
+        // the timeout doubles (by default) with every retransmission
+        simtime_t timeout = this->rpcTimeout_ * pow (this->rpcBackoff_, this->retries_);
+        this->scheduleAt (simTime () + timeout, this->rpcTimer_);
+    }
+}
 
-    // send to the chord node to whom we are connected
-    this->socket_->send (request);
+// the outstanding request was not answered in time
+void Client::rpc_timeout (void)
+{
+    if (this->retries_ < this->rpcMaxRetries_) {
+        this->retries_++;
+        CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_REQUEST_RETRANSMITTED,
+                     this->lookupKeys_[this->nextKeyIndex_], this->retries_);
+
+        // with churn the node we sent it to may have left the ring; try
+        // another one that is on it now
+        if (this->helper_->churn_active ()) {
+            Helper::NodeID entry = (*this->nodeList_)[this->pick_entry ()];
+            if (this->transport_ == Helper::OVERLAY)
+                this->entryAddress_ = this->helper_->node_host (entry);
+            else
+                this->entryAddr_ = this->helper_->lookup_node (entry);
+        }
+        this->transmit_request ();
+        return;
+    }
 
-    return;
+    // give up on this one. The coordinator counts it so that the run still ends.
+    CHORD_TRACE (this->trace_, TRACE_LOOKUP, TRACE_REQUEST_FAILED,
+                 this->lookupKeys_[this->nextKeyIndex_], this->seq_);
+    setStatusString ("lookup failed");
+    this->emit (Client::rpcRetransmissionsSignal, (long) this->retries_);
+    this->emit (Client::lookupFailedSignal, simTime ());
+    this->lookup_done ();
 }
 
 void Client::setStatusString(const char *s)
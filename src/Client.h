@@ -25,8 +25,13 @@ using namespace std;
                                                            // connected sockets
                                                            // from other peers 
 #include "inet/applications/tcpapp/TCPAppBase.h"    // we derive from app base
+#include "inet/transportlayer/contract/udp/UDPSocket.h" // datagrams for the UDP transport
 
 #include "Helper.h" // helper functions
+#include "LatencyModel.h" // delays of the overlay transport
+#include "OverlayGateway.h" // delivery of the overlay transport
+#include "Trace.h" // binary trace points
+#include "Vivaldi.h" // predicted RTTs to the chord nodes
 
 /**
  * This is our client that makes a lookup request on the node
@@ -51,24 +56,84 @@ class Client : public cSimpleModule,
 
   private:
 
+    Helper *helper_;         // ring layout and node directory of this process
+
     // these are all the variables from the NED file
     string myID_;            // our ID
     int chordNodePort_;      // port number on which the chord node listens to
     int numItersPerLookup_;  // how many iterations per lookup
-    Helper::IntVector nodeList_;     // list of chord nodes
-    Helper::IntVector lookupKeys_;      // list of keys to lookup
+    const Helper::IDVector *nodeList_;   // list of chord nodes (shared, held by the helper)
+    Helper::IDVector lookupKeys_;       // list of keys to lookup
 
     // these are the additional variables we need for the business logic
     inet::TCPSocket  *socket_;   // our socket to talk to the server
 
+    // which transport we use. With the overlay transport we send straight to
+    // the chord node module.
+    Helper::Transport transport_;
+    LatencyModel *latency_;
+    OverlayGateway *gateway_;   // of our partition
+    int address_;               // our overlay address
+    int entryAddress_;          // overlay address of the chord node we talk to
+
+    // with the UDP transport there is no connection; we retransmit a request
+    // that is not answered in time and give up after a number of attempts.
+    // With overlayRetransmit the overlay transport does the same, for hosts
+    // that leave the ring (churn).
+    inet::UDPSocket udpSocket_; // our socket
+    inet::L3Address entryAddr_; // the chord node we talk to
+    bool retransmit_;           // requests time out and are retransmitted
+    simtime_t rpcTimeout_;      // time we wait for the first answer
+    int rpcMaxRetries_;         // retransmissions before we give up on a lookup
+    double rpcBackoff_;         // factor the timeout grows by per retransmission
+    int seq_;                   // sequence number of the outstanding request
+    int retries_;               // its retransmissions so far
+    cMessage *rpcTimer_;        // its retransmission timer
+
+    // the mix of requests: these fractions of them are store operations,
+    // the rest plain lookups
+    double getFraction_;
+    double putFraction_;
+    double deleteFraction_;
+    int op_;                    // KV_Op of the outstanding request, 0 for a lookup
+    int valueSize_;             // size of the value it puts
+    long kvGets_;               // store operations answered
+    long kvGetHits_;
+    long kvPuts_;
+    long kvDeletes_;
+    long kvReplicaReads_;       // gets answered by a replica
+
+    // every answer is checked against the owner of the key on the ring
+    bool verifyLookups_;
+    bool failOnMisroute_;       // a wrong answer is an error
+    long lookupsVerified_;
+    long lookupsMisrouted_;
+
+    TraceBuffer trace_;         // our trace points
+
+    // with coordinates (vivaldi), the entry node of a lookup is the one of
+    // lowest predicted RTT out of entryCandidates_ random chord nodes
+    Vivaldi vivaldi_;
+    int entryCandidates_;
+
     // curr iteration number
     int currIter_;
 
     // index of the next lookup server
     int nextKeyIndex_;
 
+    // when we issued the connect request for the current session
+    simtime_t connectStartedAt_;
+
     static simsignal_t sentLookupSignal;
     static simsignal_t rcvdRespSignal;
+    static simsignal_t hopCountSignal;
+    static simsignal_t hopTimeSignal;
+    static simsignal_t connSetupTimeSignal;
+    static simsignal_t lookupQueueTimeSignal;
+    static simsignal_t rpcRetransmissionsSignal;
+    static simsignal_t lookupFailedSignal;
+    static simsignal_t lookupMisroutedSignal;
 
   protected:
     /**
@@ -127,6 +192,9 @@ class Client : public cSimpleModule,
     /** Invoked from handleMessage(). Should be defined to handle self-messages. */
     virtual void handleTimer (cMessage *msg);
 
+    /** index in the node list of the chord node a lookup goes to */
+    int pick_entry (void);
+
     /** Issues a connection command */
     virtual void connect (int idx);
 
@@ -136,6 +204,18 @@ class Client : public cSimpleModule,
     /** Sends a request */
     virtual void sendRequest (void);
 
+    /** (Re)transmits the outstanding request */
+    void transmit_request (void);
+
+    /** The retransmission timer of the UDP transport went off */
+    void rpc_timeout (void);
+
+    /** One iteration of a lookup is over, answered or not: move on */
+    void lookup_done (void);
+
+    /** check that the answer came from the owner of the key */
+    void verify_response (Lookup_Resp *resp);
+
     /** When running under GUI, it displays the given string next to the icon */
     virtual void setStatusString (const char *s);
     //@}
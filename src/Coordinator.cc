@@ -17,23 +17,41 @@ Define_Module(Coordinator);
 // retrieve the signal ids
 simsignal_t Coordinator::sentLookupSignal = registerSignal("sentLookupTS");
 simsignal_t Coordinator::rcvdRespSignal = registerSignal("rcvdRespTS");
+simsignal_t Coordinator::lookupFailedSignal = registerSignal("lookupFailed");
 
 Coordinator::Coordinator ()
     : cSimpleModule (),
       cListener (),
+      helper_ (nullptr),
       m_ (0),
       numChordNodes_ (0),
+      numVirtualNodes_ (1),
       numClients_ (0),
       numLookupKeys_ (0),
       numItersPerLookup_ (0),
+      exportCsv_ (true),
+      ciStopping_ (false),
+      stoppedEarly_ (false),
+      failOnUnanswered_ (false),
+      basename_ (),
       totalClientRequests_ (0),
       requestsCompleted_ (0),
-      map_ ()
+      requestsFailed_ (0),
+      map_ (),
+      writer_ (nullptr),
+      rlc_ (nullptr),
+      wallStart_ ()
 {
 }
 
 Coordinator::~Coordinator ()
 {
+    // deleting the writer flushes whatever is still buffered, so even a run
+    // that is torn down due to an error keeps the records collected so far
+    delete this->writer_;
+    delete this->rlc_;
+    if (this->helper_)
+        Helper::release ();
 }
 
 void Coordinator::initialize (int stage)
@@ -47,15 +65,28 @@ void Coordinator::initialize (int stage)
     // get our parameters
     this->m_ = this->par("m").longValue ();
     this->numChordNodes_ = this->par("numChordNodes").longValue ();
+    this->numVirtualNodes_ = this->par("numVirtualNodes").longValue ();
     this->numClients_ = this->par("numClients").longValue ();
     this->numLookupKeys_ = this->par("numLookupKeys").longValue ();
     this->numItersPerLookup_ = this->par("numItersPerLookup").longValue ();
+    this->exportCsv_ = this->par("exportCsv").boolValue ();
+    this->ciStopping_ = this->par("ciStopping").boolValue ();
+    this->failOnUnanswered_ = this->par("failOnUnanswered").boolValue ();
+
+    // the result files are named after the network unless told otherwise,
+    // e.g., to keep the runs of a parameter sweep apart
+    this->basename_ = this->par("resultBasename").stdstringValue ();
+    if (this->basename_.empty ())
+        this->basename_ = getSimulation()->getSystemModule()->getFullName();
+    this->wallStart_ = std::chrono::steady_clock::now ();
 
     // compute the total number of requests that must be completed
     this->totalClientRequests_
         = this->numClients_ * this->numLookupKeys_ * this->numItersPerLookup_;
 
     // First subscribe to get notified on these signals.
+    // Signals do not cross the partitions of a parallel run, which is why
+    // the clients must live in our partition (they check that themselves).
     // from my understanding of how signals work, they can be passed up
     // from leaf nodes to the root. But I don't think they are
     // propagated to leaves of other branches unless we subscribe.
@@ -66,13 +97,28 @@ void Coordinator::initialize (int stage)
 
     getSimulation()->getSystemModule()->subscribe (sentLookupSignal, this);
     getSimulation()->getSystemModule()->subscribe (rcvdRespSignal, this);
+    getSimulation()->getSystemModule()->subscribe (lookupFailedSignal, this);
+
+    // the helper of our process, built from the network parameters by
+    // whichever module asked first
+    this->helper_ = Helper::acquire ();
 
-    // now create the helper class and let it initialize itself
-    helper = new Helper (this->m_, this->numChordNodes_,
-                         this->numLookupKeys_, this->numItersPerLookup_);
+    // open the result sink. Records are appended in batches as responses come
+    // in rather than all at once at the end of the run.
+    this->writer_ = new ResultWriter (this->basename_,
+                                      ResultWriter::parse_format (this->par ("resultFormat").stdstringValue ()),
+                                      this->par ("resultBatchSize").longValue ());
+    this->writer_->open ();
 
-    // given the parameters, create a chord node list
-    helper->init_chord_node_list ();
+    // the RTTs are also watched for the end of the warm-up period and, if
+    // asked, for when the tail latency estimate is precise enough to stop
+    this->rlc_ = new RunLengthControl (this->par ("detectWarmup").boolValue (),
+                                       this->par ("ciQuantile").doubleValue (),
+                                       this->par ("ciConfidence").doubleValue (),
+                                       this->par ("ciRelHalfWidth").doubleValue (),
+                                       this->par ("ciNumBatches").longValue (),
+                                       this->par ("ciMinBatchSize").longValue (),
+                                       this->par ("ciCheckInterval").longValue ());
 
     EV << "=== Coordinator::initialize ===\n"
             << "\tIn stage " << stage
@@ -93,23 +139,163 @@ void Coordinator::finish ()
 {
     EV << "=== Coordinator::finish (cSimpleModule method) " << endl;
 
-    // let's dump the RTT values in a comma separated file
-    string filename = getSimulation()->getSystemModule()->getFullName();
-    filename += ".csv";
+    // push out the last partial batch and close the record files
+    this->writer_->close ();
+
+    // how evenly the work was spread over the ring. The load counters of the
+    // chord nodes in other partitions are not visible here; in a parallel
+    // run use the scalars every chord node records instead.
+    if (this->helper_->num_partitions () == 1)
+        this->load_report ();
+
+    // the RTT quantiles after the warm-up period
+    this->rtt_report ();
+
+    // lookup cost and simulator speed
+    this->scale_report ();
+
+    // if asked, also dump the RTT values in the comma separated layout we
+    // always had, i.e., one line per client with all its RTTs. The warm-up
+    // period is left out so that the file only holds steady-state values.
+    if (this->exportCsv_) {
+        string filename = this->basename_ + ".csv";
+        this->writer_->export_csv (filename, this->rlc_->warmup_length ());
+    }
+
+    // Unless we stopped the run early, every lookup is either answered or
+    // given up on by the time the events run out; any other one was lost
+    // on the way, e.g., a response a chord node could not relay back. The
+    // results above are written first, so a failed run can be looked into.
+    if (!this->stoppedEarly_) {
+        int unanswered = this->totalClientRequests_ - this->requestsCompleted_ - this->requestsFailed_;
+        recordScalar ("lookupsUnanswered", unanswered);
+        if (unanswered > 0 && this->failOnUnanswered_)
+            throw cRuntimeError("Coordinator::finish -- %d lookups were never answered", unanswered);
+    }
+}
+
+void Coordinator::rtt_report (void)
+{
+    // a final check so the warm-up length and the interval reflect every
+    // sample and not just the ones up to the last periodic check
+    this->rlc_->check ();
+
+    recordScalar ("rttSamples", this->rlc_->num_samples ());
+    recordScalar ("warmupLength", this->rlc_->warmup_length ());
+    recordScalar ("rttMean", this->rlc_->steady_mean ());
+    recordScalar ("rttP50", this->rlc_->steady_quantile (0.50));
+    recordScalar ("rttP90", this->rlc_->steady_quantile (0.90));
+    recordScalar ("rttP99", this->rlc_->steady_quantile (0.99));
+    recordScalar ("rttQuantileCICenter", this->rlc_->ci_center ());
+    recordScalar ("rttQuantileCIHalfWidth", this->rlc_->ci_half_width ());
+    recordScalar ("rttQuantileCIConverged", this->rlc_->converged () ? 1 : 0);
+
+    EV << "=== Coordinator::rtt_report: " << this->rlc_->num_samples ()
+       << " samples, warm-up " << this->rlc_->warmup_length ()
+       << ", quantile " << this->rlc_->ci_center ()
+       << " +/- " << this->rlc_->ci_half_width ()
+       << (this->rlc_->converged () ? " (converged)" : " (not converged)") << endl;
+}
+
+void Coordinator::load_report (void)
+{
+    // The chord nodes keep their load counters in the helper's load table. We
+    // summarize them together with the arc of the key space each host owns
+    // (summed over its virtual nodes): with random ID placement some hosts own
+    // far larger arcs than others, and those are the hotspots we need to size
+    // capacity for.
+    Helper::DoubleVector arcs;
+    this->helper_->host_arc_lengths (arcs);
+
+    Helper::DoubleVector requests, owned, bytes;
+    const Helper::LoadMap &loads = this->helper_->load_map ();
+    for (int host = 0; host < this->numChordNodes_; ++host) {
+        Helper::LoadMap::const_iterator lit = loads.find (host);
+        if (lit == loads.end ()) {
+            requests.push_back (0); owned.push_back (0); bytes.push_back (0);
+            continue;
+        }
+        const Helper::NodeLoad &load = lit->second;
+        requests.push_back (load.requestsOwned + load.requestsForwarded);
+        owned.push_back (load.requestsOwned);
+        bytes.push_back (load.bytesIn + load.bytesOut);
+    }
+
+    recordScalar ("loadMaxMeanRatio", Helper::max_mean_ratio (requests));
+    recordScalar ("loadGini", Helper::gini (requests));
+    recordScalar ("ownedMaxMeanRatio", Helper::max_mean_ratio (owned));
+    recordScalar ("ownedGini", Helper::gini (owned));
+    recordScalar ("bytesMaxMeanRatio", Helper::max_mean_ratio (bytes));
+    recordScalar ("bytesGini", Helper::gini (bytes));
+    recordScalar ("arcMaxMeanRatio", Helper::max_mean_ratio (arcs));
+    recordScalar ("arcGini", Helper::gini (arcs));
+
+    cHistogram arcHist ("ownershipArc");
+    for (Helper::DoubleVector::iterator it = arcs.begin (); it != arcs.end (); ++it)
+        arcHist.collect (*it);
+    arcHist.record ();
+
+    // and the per node details for post-processing
+    string filename = this->basename_ + "-load.csv";
     fstream fs;
     fs.open (filename, std::fstream::out);
-
-    // Now let us iterate thru the map and print all the RTTs
-    for (Coordinator::RTTMap::iterator it=this->map_.begin (); it !=this->map_.end (); ++it) {
-        fs << it->first;
-        Coordinator::TimeVector &tv = it->second;
-        for (Coordinator::TimeVector::iterator tvit=tv.begin (); tvit != tv.end (); ++tvit) {
-            fs << ", " << (*tvit);
+    fs << "host,ids,arc,requestsOwned,requestsForwarded,bytesIn,bytesOut,peakOpenSockets" << endl;
+    for (int host = 0; host < this->numChordNodes_; ++host) {
+        Helper::IDVector ids;
+        this->helper_->host_node_ids (host, ids);
+        Helper::LoadMap::const_iterator lit = loads.find (host);
+        fs << host << ",";
+        for (size_t i = 0; i < ids.size (); ++i)
+            fs << ((i > 0) ? " " : "") << ids[i];
+        fs << "," << arcs[host];
+        if (lit != loads.end ()) {
+            fs << "," << lit->second.requestsOwned
+               << "," << lit->second.requestsForwarded
+               << "," << lit->second.bytesIn
+               << "," << lit->second.bytesOut
+               << "," << lit->second.peakSockets;
+        } else {
+            fs << ",0,0,0,0,0";
         }
         fs << endl;
     }
     fs.close ();
 
+    EV << "=== Coordinator::load_report: load max/mean = "
+       << Helper::max_mean_ratio (requests)
+       << ", load gini = " << Helper::gini (requests)
+       << ", arc max/mean = " << Helper::max_mean_ratio (arcs)
+       << ", arc gini = " << Helper::gini (arcs) << endl;
+}
+
+void Coordinator::scale_report (void)
+{
+    // Every lookup costs the client's request plus whatever the chord nodes
+    // send on its behalf (forwarded requests and relayed responses).
+    long messages = this->requestsCompleted_;
+    const Helper::LoadMap &loads = this->helper_->load_map ();
+    for (Helper::LoadMap::const_iterator it = loads.begin (); it != loads.end (); ++it)
+        messages += it->second.messagesOut;
+
+    recordScalar ("m", this->m_);
+    recordScalar ("numChordNodes", this->numChordNodes_);
+    recordScalar ("numClients", this->numClients_);
+    recordScalar ("lookupsCompleted", this->requestsCompleted_);
+    recordScalar ("lookupsFailed", this->requestsFailed_);
+    if (this->helper_->num_partitions () == 1)
+        recordScalar ("messagesPerLookup",
+                      (this->requestsCompleted_ > 0) ? (double) messages / this->requestsCompleted_ : 0.0);
+
+    // and how fast the simulator got through it. The wall clock covers the
+    // network set-up as well, which at large ring sizes is a good part of it.
+    double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - this->wallStart_).count ();
+    eventnumber_t events = getSimulation()->getEventNumber ();
+    recordScalar ("simEvents", events);
+    recordScalar ("wallClockTime", wall);
+    recordScalar ("eventsPerSecond", (wall > 0.0) ? events / wall : 0.0);
+
+    EV << "=== Coordinator::scale_report: " << this->requestsCompleted_ << " lookups, "
+       << messages << " messages, " << events << " events in " << wall << "s" << endl;
 }
 
 void Coordinator::receiveSignal (cComponent *source, simsignal_t signalID, const SimTime &t, cObject *details)
@@ -130,7 +316,14 @@ void Coordinator::receiveSignal (cComponent *source, simsignal_t signalID, const
 
         // this signal is sent only once per request transmission by a client.
         // We use the client's fully qualified name as the "key" to store the value
-        this->map_[source->getFullPath()].push_back (t);
+        string name = source->getFullPath();
+        Coordinator::ClientMap::iterator it = this->map_.find (name);
+        if (it == this->map_.end ()) {
+            Coordinator::ClientState cs;
+            cs.index = this->writer_->client_index (name);
+            it = this->map_.insert (make_pair (name, cs)).first;
+        }
+        it->second.sentAt = t;
 
     } else if (signalID == Coordinator::rcvdRespSignal) {
         // this signal is sent only once per response packet received by a client.
@@ -144,24 +337,44 @@ void Coordinator::receiveSignal (cComponent *source, simsignal_t signalID, const
                 << "\tSignal Name = " << getSignalName (signalID)
                 << "\tSimTime = " << t
                 << "\tobject details = " << (details? details->getFullName() : "Empty")
-                << "computing " << t << " minus "
-                << this->map_[source->getFullPath()].back() << endl;
+                << endl;
 
-        // update the RTT value for this req-response
-        this->map_[source->getFullPath()].back ()
-                = t - this->map_[source->getFullPath()].back();
+        Coordinator::ClientMap::iterator it = this->map_.find (source->getFullPath());
+        if (it == this->map_.end ())
+            throw cRuntimeError("Coordinator::receiveSignal -- response without a request");
 
+        // hand the RTT value for this req-response over to the result writer
+        simtime_t rtt = t - it->second.sentAt;
+        this->writer_->append (it->second.index, it->second.sentAt, rtt);
+        bool precise = this->rlc_->add_sample (rtt.dbl ());
 
         // increment the number of requests completed so far
         this->requestsCompleted_ ++;
 
         // check if we have reached the end
-        if (this->requestsCompleted_ == this->totalClientRequests_) {
+        if (this->requestsCompleted_ + this->requestsFailed_ == this->totalClientRequests_) {
             EV << "=== Coordinator::receiveSignal: all client requests completed. "
-                    << "Calling finish" << endl;
-            getSimulation()->callFinish(); // call finish recursively on everything
+                    << "Ending simulation" << endl;
 
-            // stop the simulation
+            // stop the simulation. The simulation kernel calls finish on every
+            // module once the run ends, so we must not call it ourselves too.
+            endSimulation();
+        } else if (this->ciStopping_ && precise) {
+            EV << "=== Coordinator::receiveSignal: RTT quantile "
+                    << this->rlc_->ci_center () << " +/- " << this->rlc_->ci_half_width ()
+                    << " after a warm-up of " << this->rlc_->warmup_length ()
+                    << " samples. Ending simulation" << endl;
+
+            this->stoppedEarly_ = true;
+            endSimulation();
+        }
+    } else if (signalID == Coordinator::lookupFailedSignal) {
+        // a client gave up on a request; it has no RTT but still counts
+        // towards the end of the run
+        this->requestsFailed_ ++;
+        if (this->requestsCompleted_ + this->requestsFailed_ == this->totalClientRequests_) {
+            EV << "=== Coordinator::receiveSignal: all client requests done. "
+                    << "Ending simulation" << endl;
             endSimulation();
         }
     } else {
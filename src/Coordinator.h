@@ -8,6 +8,7 @@
 #ifndef CS6381_CHORD_P2P_Coordinator_H_
 #define CS6381_CHORD_P2P_Coordinator_H_
 
+#include <chrono>
 #include <vector>
 #include <string>
 #include <map>
@@ -18,6 +19,10 @@ using namespace omnetpp;
 
 #include "inet/common/INETDefs.h"  // this contains imp definitions from the INET
 
+#include "ResultWriter.h"   // incremental sink for the RTT records
+#include "RunLengthControl.h"   // warm-up detection and stopping rule
+#include "Helper.h"           // ring layout and load counters
+
 /**
  * This is our Coordinator
  *
@@ -27,8 +32,12 @@ using namespace omnetpp;
 class Coordinator : public cSimpleModule, public cListener
 {
 public:
-    typedef vector<simtime_t> TimeVector;
-    typedef map <string, TimeVector> RTTMap;
+    // per-client state we need to turn a send/receive signal pair into an RTT
+    struct ClientState {
+        uint32_t index;         // client index in the result writer
+        simtime_t sentAt;       // when the outstanding request was sent
+    };
+    typedef map <string, ClientState> ClientMap;
 
     /**
      *  constructor
@@ -64,22 +73,43 @@ protected:
 
     virtual void finish(cComponent *component, simsignal_t id) override;
 
+    // publish the ring-wide load and key ownership imbalance report
+    void load_report (void);
+
+    // publish the steady-state RTT summary
+    void rtt_report (void);
+
+    // publish how the lookups and the simulator itself scaled
+    void scale_report (void);
+
 private:
     static simsignal_t sentLookupSignal;
     static simsignal_t rcvdRespSignal;
+    static simsignal_t lookupFailedSignal;
+
+    Helper *helper_;            // ring layout and load counters of this process
 
     // all params obtained from simulation files
     int m_;
     int numChordNodes_;
+    int numVirtualNodes_;
     int numClients_;
     int numLookupKeys_;
     int numItersPerLookup_;
-
+    bool exportCsv_;            // write the legacy <network>.csv at the end
+    bool ciStopping_;           // end the run once the RTT quantile CI is narrow enough
+    bool stoppedEarly_;         // and it did
+    bool failOnUnanswered_;     // a lookup lost on the way is an error
+    string basename_;           // prefix of the result files we write
 
     // internal variables
     int totalClientRequests_;      // number of clients in the system
     int requestsCompleted_;        // number of client requests completed so far
-    RTTMap  map_;
+    int requestsFailed_;           // number the clients gave up on (UDP transport)
+    ClientMap  map_;               // outstanding request per client
+    ResultWriter *writer_;         // where the RTT records go
+    RunLengthControl *rlc_;        // warm-up truncation and stopping rule
+    std::chrono::steady_clock::time_point wallStart_;  // wall clock at initialization
 
 
 };
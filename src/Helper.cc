@@ -12,86 +12,414 @@ using namespace std;
 #include <omnetpp.h>
 
 #include "Helper.h"     // header file
+#include "RingSnapshot.h"   // saved ring state
 
-// we shall have the coordinator create us and initialize us
-Helper *helper = NULL;
+// the helper of this process and the number of modules holding it
+Helper *Helper::instance_ = nullptr;
+int Helper::refCount_ = 0;
+
+// the transport named by a "transport" parameter
+Helper::Transport Helper::parse_transport (const string &name)
+{
+    if (name == "tcp")
+        return Helper::TCP;
+    if (name == "udp")
+        return Helper::UDP;
+    if (name == "overlay")
+        return Helper::OVERLAY;
+    throw cRuntimeError("Helper::parse_transport -- unknown transport \"%s\"", name.c_str ());
+}
+
+Helper::~Helper (void)
+{
+    delete this->topology_;
+    delete this->snapshotIn_;
+    delete this->snapshotOut_;
+}
+
+// the helper of the running network, built on first use
+Helper *Helper::acquire (void)
+{
+    if (!Helper::instance_) {
+        // everything we need is a parameter of the network, which every
+        // process of a parallel run has, unlike the coordinator module
+        cModule *network = getSimulation ()->getSystemModule ();
+        Helper::instance_ = new Helper (network->par ("m").longValue (),
+                                        network->par ("numChordNodes").longValue (),
+                                        network->par ("numVirtualNodes").longValue (),
+                                        network->par ("numClients").longValue (),
+                                        network->par ("numLookupKeys").longValue (),
+                                        network->par ("numItersPerLookup").longValue (),
+                                        getSimulation ()->getParsimNumPartitions ());
+
+        // given the parameters, create a chord node list
+        Helper::instance_->init_chord_node_list ();
+    }
+    Helper::refCount_++;
+    return Helper::instance_;
+}
+
+// let go of the helper; the last module to do so deletes it
+void Helper::release (void)
+{
+    if (Helper::refCount_ > 0 && --Helper::refCount_ == 0) {
+        delete Helper::instance_;
+        Helper::instance_ = nullptr;
+    }
+}
 
 // initialize the helper class. In particular, initialize a randomly created
 // list of chord nodes
 void Helper::init_chord_node_list (void)
 {
     // our goal is to generate a bunch of node IDs that
-    // lie in the range 0 to 2^m - 1 without any repetitions
-    int key_space = (1 << this->m_);
-    Helper::IntSet  is;
-    std::mt19937 generator (key_space); // mersenne_twister_engine random num generator
-    for (int i = 1; i <= this->numChordNodes_; ++i) {
+    // lie in the range 0 to 2^m - 1 without any repetitions. Every chord
+    // node runs numVirtualNodes of them.
+    if (this->m_ < 1 || this->m_ > Helper::MAX_BITS)
+        throw cRuntimeError("Helper::init_chord_node_list -- m = %d is outside 1..%d",
+                            this->m_, Helper::MAX_BITS);
+
+    Helper::NodeID key_space = this->key_space ();
+    int numIDs = this->numChordNodes_ * this->numVirtualNodes_;
+    if (numIDs > key_space)
+        throw cRuntimeError("Helper::init_chord_node_list -- %d node IDs do not fit in a key space of %lld",
+                            numIDs, (long long) key_space);
+
+    Helper::IDSet  is;
+    std::mt19937 generator ((std::mt19937::result_type) key_space); // mersenne_twister_engine random num generator
+    for (int i = 1; i <= numIDs; ++i) {
         // we need unique node ids. It is possible that a random num gen
         // will produce same num and we don't want to add the same num to the
         // set. So we keep inserting a new number until our length is the same
         // as what our current notion of size of the array ought to be
         while (is.size () != i) {
-            int id = generator () % key_space;   // generates a number between 0 .. key-space-1
+            Helper::NodeID id = generator () % key_space;   // generates a number between 0 .. key-space-1
             is.insert (id);
         }
     }
 
     // now copy over all elements of the set to our vector
-    for (Helper::IntSet::iterator it = is.begin (); it != is.end (); ++it) {
+    for (Helper::IDSet::iterator it = is.begin (); it != is.end (); ++it) {
         EV << "+++++ generated node id = " << (*it) << endl;
         this->chordNodeList_.push_back (*it);
     }
+
+    // hand the IDs out to the hosts in random order so that the virtual
+    // nodes of one host are scattered over the ring
+    this->hostIDs_ = this->chordNodeList_;
+    std::shuffle (this->hostIDs_.begin (), this->hostIDs_.end (), generator);
+
+    // every process knows which host runs which node; the addresses are
+    // filled in as the nodes register
+    for (size_t i = 0; i < this->hostIDs_.size (); ++i) {
+        Helper::Id2AddrEntry &entry = this->map_[this->hostIDs_[i]];
+        entry.nodeID = this->hostIDs_[i];
+        entry.hostIndex = i / this->numVirtualNodes_;
+    }
+}
+
+// return the IDs of the virtual nodes run by the given host
+void Helper::host_node_ids (int hostIndex, Helper::IDVector &iv)
+{
+    int v = this->numVirtualNodes_;
+    int first = (hostIndex % this->numChordNodes_) * v;
+    iv.assign (this->hostIDs_.begin () + first, this->hostIDs_.begin () + first + v);
+    sort (iv.begin (), iv.end ());
+}
+
+// from now on hosts may leave the ring and come back
+void Helper::enable_churn (void)
+{
+    if (this->churn_active ())
+        return;
+    this->hostUp_.assign (this->numChordNodes_, 1);
+    this->numLiveHosts_ = this->numChordNodes_;
+}
+
+// take a host off the ring or put it back
+void Helper::set_host_up (int hostIndex, bool up)
+{
+    if (hostIndex < 0 || hostIndex >= (int) this->hostUp_.size ())
+        throw cRuntimeError("Helper::set_host_up -- host %d out of range (is churn enabled?)", hostIndex);
+    if ((bool) this->hostUp_[hostIndex] == up)
+        return;
+    this->hostUp_[hostIndex] = up;
+    this->numLiveHosts_ += up ? 1 : -1;
+
+    // The ring is made over from the IDs of the hosts that are up, which
+    // keeps it sorted without a search per virtual node. The successor
+    // tables refer to positions on it and are swept out again on demand.
+    this->chordNodeList_.clear ();
+    for (size_t i = 0; i < this->hostIDs_.size (); ++i) {
+        if (this->hostUp_[i / this->numVirtualNodes_])
+            this->chordNodeList_.push_back (this->hostIDs_[i]);
+    }
+    std::sort (this->chordNodeList_.begin (), this->chordNodeList_.end ());
+    this->successorTables_.clear ();
+}
+
+// the node owning a key: a binary search over the sorted ring
+Helper::NodeID Helper::key_owner (Helper::NodeID key) const
+{
+    if (this->chordNodeList_.empty ())
+        throw cRuntimeError("Helper::key_owner -- no host is on the ring");
+    Helper::IDVector::const_iterator it
+        = lower_bound (this->chordNodeList_.begin (), this->chordNodeList_.end (), key);
+    return (it == this->chordNodeList_.end ()) ? this->chordNodeList_.front () : *it;
+}
+
+// the successors of every node plus each offset, built once per set of offsets
+const Helper::IntVector &Helper::successor_table (const Helper::IDVector &offsets)
+{
+    map<IDVector, IntVector>::iterator it = this->successorTables_.find (offsets);
+    if (it != this->successorTables_.end ())
+        return it->second;
+
+    IntVector &table = this->successorTables_[offsets];
+    Helper::sweep_successors (this->chordNodeList_, this->key_space (), offsets, table);
+    EV << "=== Helper::successor_table -- " << this->chordNodeList_.size () << " nodes x "
+       << offsets.size () << " offsets" << endl;
+    return table;
+}
+
+// one merge-style sweep over the sorted ring
+void Helper::sweep_successors (const Helper::IDVector &ring, Helper::NodeID keySpace,
+                               const Helper::IDVector &offsets, Helper::IntVector &table)
+{
+    // Node i plus an offset grows with i, so the successor of it only ever
+    // moves forward: one cursor per offset walks the ring unrolled twice
+    // (position p >= n stands for ring[p - n] + keySpace), and the row
+    // of every node is written in one go. That is O(n * offsets) in all,
+    // rather than a binary search per entry.
+    size_t n = ring.size ();
+    size_t f = offsets.size ();
+    table.assign (n * f, 0);
+    vector<size_t> cursor (f, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 0; k < f; ++k) {
+            Helper::NodeID target = ring[i] + offsets[k] % keySpace;   // not wrapped
+            size_t p = cursor[k];
+            while ((p < n ? ring[p] : ring[p - n] + keySpace) < target)
+                p++;
+            cursor[k] = p;
+            table[i * f + k] = (p < n) ? p : p - n;
+        }
+    }
 }
 
 // create a randomly generated set of lookup keys for the client to use
-void Helper::gen_lookup_keys (Helper::IntVector &iv)
+void Helper::gen_lookup_keys (Helper::IDVector &iv)
 {
     // we will add logic later
     // return string ("2 0 6 1 12 15 10 8 4 3 13");
-    int key_space = (1 << this->m_);
-    std::mt19937 generator (key_space); // mersenne_twister_engine random num generator
+    Helper::NodeID key_space = this->key_space ();
+    std::mt19937 generator ((std::mt19937::result_type) key_space); // mersenne_twister_engine random num generator
     for (int i = 0; i < this->numLookupKeys_; ++i) {
         iv.push_back (generator () % key_space);
     }
-    for (Helper::IntVector::iterator it = iv.begin (); it != iv.end (); ++it) {
+    for (Helper::IDVector::iterator it = iv.begin (); it != iv.end (); ++it) {
         EV << "+++++ generated lookup key = " << (*it) << endl;
     }
 }
 
-// return the generated list of nodes
-void Helper::chord_node_list (Helper::IntVector &iv)
+// lookup a node based on its id and return its addr
+inet::L3Address Helper::lookup_node (Helper::NodeID nodeID)
 {
-    iv = this->chordNodeList_;
-    return;
+    // search our map. It is keyed by node ID since every node resolves
+    // all its fingers through here, which with a linear scan made building
+    // a large ring quadratic in the ring size.
+    Helper::Id2AddrMap::iterator it = this->map_.find (nodeID);
+    if (it != this->map_.end ())
+        return it->second.addr;
+
+    // if not found, technically we should throw an exception
+    inet::L3Address addr;
+    return addr;
 }
 
-// lookup a node based on its id and return its addr
-inet::L3Address Helper::lookup_node (int nodeID)
+// lookup a node based on its id and return the host running it
+int Helper::node_host (Helper::NodeID nodeID)
+{
+    Helper::Id2AddrMap::iterator it = this->map_.find (nodeID);
+    return (it != this->map_.end ()) ? it->second.hostIndex : -1;
+}
+
+// the partition an endpoint of the overlay transport lives on
+int Helper::partition_of (int address)
+{
+    if (address >= this->numChordNodes_)
+        return 0;
+    return (int) ((int64_t) address * this->numPartitions_ / this->numChordNodes_);
+}
+
+// the file of this process for a snapshot path
+string Helper::snapshot_path (const string &path)
 {
-    EV << "==== Helper::lookup_node: nodeID = " << nodeID
-       << " =====" << endl;
+    if (this->numPartitions_ <= 1)
+        return path;
+    return path + "." + std::to_string (getSimulation ()->getParsimProcId ());
+}
 
-    // search our map
-    for (Helper::Id2AddrMap::iterator it = this->map_.begin ();
-            it != this->map_.end (); ++it) {
-        if ((*it).nodeID == nodeID)
-            return (*it).addr;
+// the snapshot we were started from, read on first use
+const RingSnapshot &Helper::snapshot_in (const string &path)
+{
+    if (!this->snapshotIn_) {
+        string file = this->snapshot_path (path);
+        this->snapshotIn_ = new RingSnapshot ();
+        this->snapshotIn_->read (file);
+        if (this->snapshotIn_->m != this->m_
+                || this->snapshotIn_->numVirtualNodes != this->numVirtualNodes_
+                || this->snapshotIn_->hostIDs != this->hostIDs_)
+            throw cRuntimeError("Helper::snapshot_in -- %s was taken of a different ring "
+                                "(m = %d, %d x %d node IDs)", file.c_str (), this->snapshotIn_->m,
+                                (int) this->snapshotIn_->hostIDs.size () / max (this->snapshotIn_->numVirtualNodes, 1),
+                                this->snapshotIn_->numVirtualNodes);
+        EV << "=== Helper::snapshot_in -- " << file << ": "
+           << this->snapshotIn_->hosts.size () << " hosts" << endl;
     }
+    return *this->snapshotIn_;
+}
 
-    // if not found, technically we should throw an exception
-    inet::L3Address addr;
-    return addr;
+// the snapshot the chord hosts of this process fill in
+RingSnapshot &Helper::snapshot_out (const string &routingTable)
+{
+    if (!this->snapshotOut_) {
+        this->snapshotOut_ = new RingSnapshot ();
+        this->snapshotOut_->m = this->m_;
+        this->snapshotOut_->numVirtualNodes = this->numVirtualNodes_;
+        this->snapshotOut_->routingTable = routingTable;
+        this->snapshotOut_->hostIDs = this->hostIDs_;
+    }
+    return *this->snapshotOut_;
+}
+
+// write the snapshot once every chord host of this process is in it
+void Helper::snapshot_done (const string &path)
+{
+    int procId = getSimulation ()->getParsimProcId ();
+    size_t local = 0;
+    for (int h = 0; h < this->numChordNodes_; ++h) {
+        if (this->partition_of (h) == procId)
+            local++;
+    }
+    if (!this->snapshotOut_ || this->snapshotOut_->hosts.size () < local)
+        return;
+
+    string file = this->snapshot_path (path);
+    this->snapshotOut_->write (file);
+    EV << "=== Helper::snapshot_done -- wrote " << file << ": "
+       << this->snapshotOut_->hosts.size () << " hosts" << endl;
+}
+
+// remember the module of a local endpoint
+void Helper::register_endpoint (int address, int moduleId)
+{
+    if (address < 0 || address >= (int) this->endpoints_.size ())
+        throw cRuntimeError("Helper::register_endpoint -- address %d out of range", address);
+    this->endpoints_[address] = moduleId;
+}
+
+// the module of an endpoint, -1 if it lives in another partition
+int Helper::endpoint_module (int address)
+{
+    if (address < 0 || address >= (int) this->endpoints_.size ())
+        return -1;
+    return this->endpoints_[address];
+}
+
+// propagation delay between two chord hosts along the shortest path
+double Helper::path_delay (int fromHost, int toHost)
+{
+    if (!this->topology_) {
+        // INET marks hosts, routers and switches as network nodes. Every
+        // link weighs as much as the delay of its channel.
+        this->topology_ = new cTopology ("chordTopology");
+        this->topology_->extractByProperty ("networkNode");
+        for (int i = 0; i < this->topology_->getNumNodes (); ++i) {
+            cTopology::Node *node = this->topology_->getNode (i);
+            for (int j = 0; j < node->getNumOutLinks (); ++j) {
+                cTopology::LinkOut *link = node->getLinkOut (j);
+                cChannel *channel = link->getLocalGate ()->getChannel ();
+                double delay = (channel && channel->hasPar ("delay")) ? channel->par ("delay").doubleValue () : 0.0;
+                link->setWeight (delay);
+            }
+        }
+    }
+
+    // one run of Dijkstra towards a host gives the delays from all others,
+    // which is what a chord node needs for its finger candidates
+    Helper::DoubleVector &delays = this->pathDelays_[toHost];
+    if (delays.empty ()) {
+        cModule *network = getSimulation ()->getSystemModule ();
+        cTopology::Node *target = this->topology_->getNodeFor (network->getSubmodule ("chordHosts", toHost));
+        delays.assign (this->numChordNodes_, -1.0);
+        if (target) {
+            this->topology_->calculateWeightedSingleShortestPathsTo (target);
+            for (int h = 0; h < this->numChordNodes_; ++h) {
+                cTopology::Node *node = this->topology_->getNodeFor (network->getSubmodule ("chordHosts", h));
+                if (node && node->getNumPaths () > 0)
+                    delays[h] = node->getDistanceToTarget ();
+            }
+            delays[toHost] = 0.0;
+        }
+    }
+    return (fromHost >= 0 && fromHost < (int) delays.size ()) ? delays[fromHost] : -1.0;
+}
+
+// the load counters of a host, created zeroed on first access
+Helper::NodeLoad *Helper::node_load (int hostIndex)
+{
+    Helper::LoadMap::iterator it = this->loadMap_.find (hostIndex);
+    if (it == this->loadMap_.end ()) {
+        Helper::NodeLoad load = { 0, 0, 0, 0, 0, 0, 0 };
+        it = this->loadMap_.insert (make_pair (hostIndex, load)).first;
+    }
+    return &it->second;
+}
+
+// length of the arc of the key space owned by each node
+void Helper::arc_lengths (Helper::DoubleVector &dv)
+{
+    // a node owns the keys in (predecessor, node], so its arc is the distance
+    // from its predecessor. The first node wraps around to the last one.
+    Helper::NodeID key_space = this->key_space ();
+    int n = this->chordNodeList_.size ();
+    for (int i = 0; i < n; ++i) {
+        Helper::NodeID pred = this->chordNodeList_[(i + n - 1) % n];
+        Helper::NodeID arc = (this->chordNodeList_[i] - pred + key_space) % key_space;
+        dv.push_back ((arc == 0) ? key_space : arc);   // a lone node owns everything
+    }
+}
+
+// length of the key space owned by each host
+void Helper::host_arc_lengths (Helper::DoubleVector &dv)
+{
+    Helper::DoubleVector arcs;
+    this->arc_lengths (arcs);
+
+    // with churn, the ring only holds the nodes of the hosts that are up;
+    // those that are down own nothing
+    dv.assign (this->numChordNodes_, 0.0);
+    for (size_t i = 0; i < this->hostIDs_.size (); ++i) {
+        int host = i / this->numVirtualNodes_;
+        if (!this->host_up (host))
+            continue;
+        Helper::IDVector::iterator it = lower_bound (this->chordNodeList_.begin (),
+                                                      this->chordNodeList_.end (),
+                                                      this->hostIDs_[i]);
+        dv[host] += arcs[it - this->chordNodeList_.begin ()];
+    }
 }
 
 // register_node
-void Helper::register_node (int nodeID, const inet::L3Address &addr)
+void Helper::register_node (Helper::NodeID nodeID, const inet::L3Address &addr)
 {
     EV << "==== Helper::register_node: nodeID = " << nodeID
        << ", addr = " << addr.str () << " =====" << endl;
-    Helper::Id2AddrEntry entry;
-    entry.nodeID = nodeID;
-    entry.addr = addr;
-    this->map_.push_back (entry);
+    Helper::Id2AddrMap::iterator it = this->map_.find (nodeID);
+    if (it == this->map_.end ())
+        throw cRuntimeError("Helper::register_node -- unknown node ID %lld", (long long) nodeID);
+    it->second.addr = addr;
 }
 
 void Helper::tokenize_and_sort (const string &s, IntVector &iv)
@@ -123,3 +451,47 @@ void Helper::tokenize_and_sort (const string &s, IntVector &iv)
     EV << endl;
 }
 
+// is id in the ring interval (from, to), or (from, to] if closedRight is set
+bool Helper::in_interval (Helper::NodeID id, Helper::NodeID from, Helper::NodeID to, bool closedRight)
+{
+    bool belowTo = closedRight ? (id <= to) : (id < to);
+    if (from < to)
+        return (id > from) && belowTo;
+
+    // the interval wraps around zero
+    return (id > from) || belowTo;
+}
+
+// Gini coefficient of a set of non-negative values
+double Helper::gini (const Helper::DoubleVector &dv)
+{
+    // with the values sorted ascending, G = sum_i (2i - n + 1) x_i / (n sum x)
+    if (dv.empty ())
+        return 0.0;
+
+    DoubleVector sorted (dv);
+    sort (sorted.begin (), sorted.end ());
+
+    double n = sorted.size ();
+    double sum = 0.0, weighted = 0.0;
+    for (size_t i = 0; i < sorted.size (); ++i) {
+        sum += sorted[i];
+        weighted += (2.0 * i - n + 1.0) * sorted[i];
+    }
+    return (sum > 0.0) ? weighted / (n * sum) : 0.0;
+}
+
+// ratio of the largest value to the mean
+double Helper::max_mean_ratio (const Helper::DoubleVector &dv)
+{
+    if (dv.empty ())
+        return 0.0;
+
+    double sum = 0.0, max = dv[0];
+    for (size_t i = 0; i < dv.size (); ++i) {
+        sum += dv[i];
+        if (dv[i] > max)
+            max = dv[i];
+    }
+    return (sum > 0.0) ? max / (sum / dv.size ()) : 0.0;
+}
@@ -8,79 +8,255 @@
 #ifndef CS6381_CHORD_P2P_HELPER_H_
 #define CS6381_CHORD_P2P_HELPER_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
 using namespace std;
 
 #include "inet/networklayer/common/L3AddressResolver.h"
 
+class RingSnapshot;
+
 class Helper {
 public:
+    // Node IDs and keys are 64 bit wide so that key spaces of up to 2^32
+    // (i.e., m = 32) can be simulated.
+    typedef int64_t NodeID;
+
     // this is a data structure to maintain the mapping between
     // a chord node Id and its IP address
     struct Id2AddrEntry {
-        int nodeID;             // chord node ID
+        NodeID nodeID;          // chord node ID
         string moduleName;      // module name
         inet::L3Address addr;   // L3Address
+        int hostIndex;          // index of the chord host running the node
     };
-    typedef vector<Id2AddrEntry> Id2AddrMap;
+    typedef map<NodeID, Id2AddrEntry> Id2AddrMap;     // indexed by node ID
 
     typedef vector<int> IntVector;
-    typedef set<int> IntSet;
+    typedef vector<NodeID> IDVector;
+    typedef set<NodeID> IDSet;
+    typedef vector<double> DoubleVector;
+
+    // largest m we support; the IDs are drawn from a 32 bit generator
+    static const int MAX_BITS = 32;
+
+    // how chord nodes and clients exchange their messages: TCP connections,
+    // UDP datagrams (with retransmission by the client), or the overlay
+    // transport without any stack
+    enum Transport { TCP, UDP, OVERLAY };
+
+    // the transport named by a "transport" parameter
+    static Transport parse_transport (const string &name);
 
-    Helper (int m, int numChordNodes, int numLookupKeys, int numItersPerLookup)
+    // load counters maintained by every chord node (i.e., per physical host,
+    // covering all its virtual nodes). They live here so that the
+    // coordinator can build the ring-wide report without reaching into the nodes.
+    struct NodeLoad {
+        long requestsOwned;     // lookups answered as the owner of the key
+        long requestsForwarded; // lookups passed on to a finger
+        long bytesIn;           // bytes received by the chord node
+        long bytesOut;          // bytes sent by the chord node
+        long messagesOut;       // messages sent by the chord node
+        int openSockets;        // sockets currently in the node's socket map
+        int peakSockets;        // largest value openSockets ever had
+    };
+    typedef map<int, NodeLoad> LoadMap;     // indexed by host index
+
+    Helper (int m, int numChordNodes, int numVirtualNodes, int numClients,
+            int numLookupKeys, int numItersPerLookup, int numPartitions)
         : m_ (m),
           numChordNodes_ (numChordNodes),
+          numVirtualNodes_ (numVirtualNodes),
+          numClients_ (numClients),
           numLookupKeys_ (numLookupKeys),
           numItersPerLookup_ (numItersPerLookup),
+          numPartitions_ (numPartitions),
           chordNodeList_ (),
-          map_ ()
+          hostIDs_ (),
+          map_ (),
+          loadMap_ (),
+          endpoints_ (numChordNodes + numClients, -1),
+          successorTables_ (),
+          hostUp_ (),
+          numLiveHosts_ (numChordNodes),
+          snapshotIn_ (nullptr),
+          snapshotOut_ (nullptr),
+          topology_ (nullptr),
+          pathDelays_ ()
     {
     }
 
-    ~Helper (void) {}
+    ~Helper (void);
+
+    // The helper of the running network. It is built from the network's
+    // parameters by whichever module asks first, so that every process of a
+    // parallel run builds the same one on its own. Every module that acquires
+    // it must release it when it goes away; the last one deletes it.
+    static Helper *acquire (void);
+    static void release (void);
 
     // initialize the helper class. In particular, initialize a randomly created
-    // list of chord nodes
+    // list of chord node IDs (numVirtualNodes per host) and hand them out to
+    // the hosts
     void init_chord_node_list (void);
 
     // the bits used to encode the total key space
     int num_bits (void) { return this->m_;}
 
-    // the total num of chord nodes
+    // size of the key space, i.e., 2^m
+    NodeID key_space (void) { return ((NodeID) 1) << this->m_; }
+
+    // the total num of chord nodes, i.e., physical hosts running the chord logic
     int num_chord_nodes (void) {return this->numChordNodes_; }
 
+    // the num of virtual nodes (ring IDs) run by every chord node
+    int num_virtual_nodes (void) {return this->numVirtualNodes_; }
+
     // the total num of chord nodes
     int num_iters_per_lookup (void) {return this->numItersPerLookup_; }
 
     // create a randomly generated set of lookup keys for the client to use
-    void gen_lookup_keys (IntVector &iv);
+    void gen_lookup_keys (IDVector &iv);
+
+    // the generated list of chord node IDs in sorted order. Nodes and clients
+    // refer to this one list rather than each keeping a copy of it. With
+    // churn it holds the nodes of the hosts that are up only.
+    const IDVector &chord_node_list (void) const { return this->chordNodeList_; }
+
+    // Churn (see ChurnDriver). Once enabled, hosts can be taken off the ring
+    // and put back; the chord node list and the successor tables follow.
+    void enable_churn (void);
+    bool churn_active (void) const { return !this->hostUp_.empty (); }
+    void set_host_up (int hostIndex, bool up);
+    bool host_up (int hostIndex) const { return this->hostUp_.empty () || this->hostUp_[hostIndex]; }
+    int num_live_hosts (void) const { return this->numLiveHosts_; }
 
-    // return the generated list of chord node IDs in sorted order
-    void chord_node_list (IntVector &iv);
+    // return the IDs of the virtual nodes run by the given host
+    void host_node_ids (int hostIndex, IDVector &iv);
+
+    // the node owning a key, i.e., its successor on the ring: the ground
+    // truth lookups are checked against
+    NodeID key_owner (NodeID key) const;
+
+    // The successors of every node ID plus each of the given offsets (e.g.,
+    // the finger offsets): entry [i * offsets.size () + k] is the index in
+    // the chord node list of the successor of node i + offsets[k]. Built on
+    // first use for a set of offsets in one sweep over the ring and shared by
+    // all the nodes of the process, which load their rows from it.
+    const IntVector &successor_table (const IDVector &offsets);
+
+    // the sweep itself, for the given sorted ring
+    static void sweep_successors (const IDVector &ring, NodeID keySpace,
+                                  const IDVector &offsets, IntVector &table);
 
     // register_node. Every chord node will register with this helper database
-    // when it has initialized itself and has its IP address
-    void register_node (int nodeID, const inet::L3Address &addr);
+    // when it has initialized itself and has its IP address (which is
+    // unspecified with the overlay transport)
+    void register_node (NodeID nodeID, const inet::L3Address &addr);
 
     // lookup a node based on its id and return its addr
-    inet::L3Address lookup_node (int nodeID);
+    inet::L3Address lookup_node (NodeID nodeID);
+
+    // the host running the node with the given id, -1 if unknown
+    int node_host (NodeID nodeID);
+
+    // Endpoints of the overlay transport are addressed by their position in
+    // the network rather than by module ID, which differs between the
+    // processes of a parallel run: chord host h has address h and client c
+    // has address numChordNodes + c.
+    int client_address (int clientIndex) { return this->numChordNodes_ + clientIndex; }
+
+    // the partition an endpoint lives on. Chord hosts are split into equal
+    // blocks of consecutive indices, one per partition; clients (and the
+    // coordinator) live on partition 0. The partition-id settings of a
+    // parallel config must follow the same rule.
+    int partition_of (int address);
+
+    // the number of partitions of the run (1 unless it is a parallel one)
+    int num_partitions (void) { return this->numPartitions_; }
+
+    // every endpoint registers its module ID with the helper of its own
+    // process; endpoint_module returns -1 for those living in other partitions
+    void register_endpoint (int address, int moduleId);
+    int endpoint_module (int address);
+
+    // One-way propagation delay between two chord hosts along the shortest
+    // path through the network, i.e., the sum of the delays of its links.
+    // This is what proximity based finger selection uses as a distance with
+    // the TCP and UDP transports, before any message has been exchanged. The
+    // network topology is extracted on first use; -1 if either host is not
+    // part of it.
+    double path_delay (int fromHost, int toHost);
+
+    // Ring snapshots (see RingSnapshot). snapshot_in reads the file on first
+    // use and checks that it was taken of this very ring. The chord hosts of
+    // the process fill in their state in the one of snapshot_out, which
+    // snapshot_done writes once all of them did. In a parallel run every
+    // process has its own file, the path suffixed with its partition.
+    const RingSnapshot &snapshot_in (const string &path);
+    RingSnapshot &snapshot_out (const string &routingTable);
+    void snapshot_done (const string &path);
+
+    // the load counters of a host, created zeroed on first access
+    NodeLoad *node_load (int hostIndex);
+
+    // load counters of all the hosts, indexed by host index
+    const LoadMap &load_map (void) { return this->loadMap_; }
+
+    // length of the arc of the key space owned by each node ID, in the order of
+    // the (sorted) chord node list
+    void arc_lengths (DoubleVector &dv);
+
+    // length of the key space owned by each host, i.e., the sum of the arcs
+    // of its virtual nodes, indexed by host index
+    void host_arc_lengths (DoubleVector &dv);
 
     // here we define some helper functions that can be used by our applications
     void tokenize_and_sort (const string &s, IntVector &iv);
 
+    // is id in the ring interval (from, to), or (from, to] if closedRight is
+    // set. The interval wraps around zero when from >= to, so (n, n] is the
+    // whole ring.
+    static bool in_interval (NodeID id, NodeID from, NodeID to, bool closedRight);
+
+    // Gini coefficient of a set of non-negative values: 0 when all are equal,
+    // approaching 1 when a single value holds everything
+    static double gini (const DoubleVector &dv);
+
+    // ratio of the largest value to the mean
+    static double max_mean_ratio (const DoubleVector &dv);
+
 private:
     int m_;                 // num of bits
     int numChordNodes_;     // num of chord nodes
+    int numVirtualNodes_;   // num of virtual nodes per chord node
+    int numClients_;        // num of clients
     int numLookupKeys_;     // num of lookup keys to generate
     int numItersPerLookup_; // num of iterations per lookup request
+    int numPartitions_;     // num of partitions of a parallel run
 
-    IntVector chordNodeList_;  // list of chord nodes generated
+    IDVector chordNodeList_;   // list of chord nodes generated
+    IDVector hostIDs_;         // IDs in host order: host h runs [h*v, (h+1)*v)
     Id2AddrMap  map_;       // database of node ID and IP address mapping
-};
+    LoadMap  loadMap_;      // load counters of every chord node
+    IntVector endpoints_;   // module ID of every local endpoint, by address
+    map<IDVector, IntVector> successorTables_;  // successor tables by offsets
+    vector<char> hostUp_;   // which hosts are on the ring; empty without churn
+    int numLiveHosts_;
+    RingSnapshot *snapshotIn_;      // the snapshot we were started from
+    RingSnapshot *snapshotOut_;     // the one we are collecting
+
+    omnetpp::cTopology *topology_;      // the network nodes, for path_delay
+    map<int, DoubleVector> pathDelays_; // delays from every chord host, by destination host
 
-// a global variable used by all other modules
-extern Helper *helper;
+    // the file of this process for a snapshot path
+    string snapshot_path (const string &path);
+
+    static Helper *instance_;   // the helper of this process
+    static int refCount_;       // number of modules holding it
+};
 
 #endif /* CS6381_CHORD_P2P_HELPER_H_ */
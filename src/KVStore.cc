@@ -0,0 +1,170 @@
+/*
+ * KVStore.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstring>
+
+#include "KVStore.h"
+
+KVStore::KVStore (size_t initialSlots, size_t blockSize)
+    : slots_ (nullptr),
+      capacity_ (0),
+      live_ (0),
+      deleted_ (0),
+      bytes_ (0),
+      blocks_ (),
+      blockSize_ (blockSize),
+      next_ (nullptr),
+      left_ (0),
+      arenaBytes_ (0),
+      spare_ (nullptr),
+      spareCapacity_ (0)
+{
+    // keep the load below 70% with initialSlots keys in
+    size_t n = 16;
+    while (n * 7 < initialSlots * 10)
+        n <<= 1;
+    this->slots_ = this->allocate (n);
+    this->capacity_ = n;
+}
+
+KVStore::~KVStore ()
+{
+    for (size_t i = 0; i < this->blocks_.size (); ++i)
+        delete [] this->blocks_[i];
+}
+
+KVStore::Slot *KVStore::allocate (size_t n)
+{
+    size_t need = n * sizeof (KVStore::Slot);
+    if (need > this->left_) {
+        size_t size = (need > this->blockSize_) ? need : this->blockSize_;
+        char *block = new char [size];
+        this->blocks_.push_back (block);
+        this->arenaBytes_ += size;
+        this->next_ = block;
+        this->left_ = size;
+    }
+
+    // the block is only ever carved into slot arrays, so what we hand out
+    // stays aligned for them
+    KVStore::Slot *slots = reinterpret_cast<KVStore::Slot *> (this->next_);
+    this->next_ += need;
+    this->left_ -= need;
+    memset (slots, 0, need);    // all EMPTY
+    return slots;
+}
+
+size_t KVStore::hash (KVStore::Key key)
+{
+    // the finalizer of splitmix64; chord keys are already spread over the
+    // key space but their low bits need not be
+    uint64_t z = (uint64_t) key;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (size_t) (z ^ (z >> 31));
+}
+
+KVStore::Slot *KVStore::find (KVStore::Key key) const
+{
+    size_t mask = this->capacity_ - 1;
+    for (size_t i = KVStore::hash (key) & mask; ; i = (i + 1) & mask) {
+        KVStore::Slot *s = &this->slots_[i];
+        if (s->state == KVStore::EMPTY)
+            return nullptr;
+        if (s->state == KVStore::FULL && s->key == key)
+            return s;
+    }
+}
+
+bool KVStore::get (KVStore::Key key, int32_t &size) const
+{
+    KVStore::Slot *s = this->find (key);
+    if (!s)
+        return false;
+    size = s->size;
+    return true;
+}
+
+bool KVStore::put (KVStore::Key key, int32_t size)
+{
+    KVStore::Slot *s = this->find (key);
+    if (s) {
+        this->bytes_ += size - s->size;
+        s->size = size;
+        return true;
+    }
+
+    if ((this->live_ + this->deleted_ + 1) * 10 > this->capacity_ * 7) {
+        // mostly tombstones: clean up at the same size
+        size_t n = this->capacity_;
+        if ((this->live_ + 1) * 10 > n * 3)
+            n <<= 1;
+        this->rehash (n);
+    }
+
+    // take the first free slot on the probe sequence, reusing a tombstone
+    size_t mask = this->capacity_ - 1;
+    size_t i = KVStore::hash (key) & mask;
+    while (this->slots_[i].state == KVStore::FULL)
+        i = (i + 1) & mask;
+    if (this->slots_[i].state == KVStore::DELETED)
+        this->deleted_--;
+    this->slots_[i].key = key;
+    this->slots_[i].size = size;
+    this->slots_[i].state = KVStore::FULL;
+    this->live_++;
+    this->bytes_ += size;
+    return false;
+}
+
+bool KVStore::remove (KVStore::Key key)
+{
+    KVStore::Slot *s = this->find (key);
+    if (!s)
+        return false;
+    s->state = KVStore::DELETED;
+    this->bytes_ -= s->size;
+    this->live_--;
+    this->deleted_++;
+    return true;
+}
+
+void KVStore::entries (vector<KVStore::Entry> &out) const
+{
+    for (size_t i = 0; i < this->capacity_; ++i) {
+        if (this->slots_[i].state == KVStore::FULL)
+            out.push_back (KVStore::Entry (this->slots_[i].key, this->slots_[i].size));
+    }
+}
+
+void KVStore::rehash (size_t newCapacity)
+{
+    KVStore::Slot *old = this->slots_;
+    size_t oldCapacity = this->capacity_;
+
+    // the spare array will do if it has the size; it is cleared like a new one
+    if (this->spare_ && this->spareCapacity_ == newCapacity) {
+        this->slots_ = this->spare_;
+        memset (this->slots_, 0, newCapacity * sizeof (KVStore::Slot));
+    } else {
+        this->slots_ = this->allocate (newCapacity);
+    }
+    this->capacity_ = newCapacity;
+    this->deleted_ = 0;
+
+    size_t mask = newCapacity - 1;
+    for (size_t j = 0; j < oldCapacity; ++j) {
+        if (old[j].state != KVStore::FULL)
+            continue;
+        size_t i = KVStore::hash (old[j].key) & mask;
+        while (this->slots_[i].state != KVStore::EMPTY)
+            i = (i + 1) & mask;
+        this->slots_[i] = old[j];
+    }
+    // the old array stays in the arena, as the spare for the next rebuild
+    this->spare_ = old;
+    this->spareCapacity_ = oldCapacity;
+}
@@ -0,0 +1,103 @@
+/*
+ * KVStore.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_KVSTORE_H_
+#define CS6381_CHORD_P2P_KVSTORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+using namespace std;
+
+/**
+ * The key/value store of a chord node. Values are modelled by their size
+ * only; nothing but the key and that size is kept.
+ *
+ * It is an open-addressing hash table with linear probing over a power of
+ * two number of slots. Deleted keys leave a tombstone behind so that probe
+ * sequences stay intact; the table is rebuilt at twice the size once live
+ * keys and tombstones fill 70% of it (at the same size if it is mostly
+ * tombstones).
+ *
+ * The slot arrays come from an arena: a list of large blocks handed out by
+ * bumping a pointer, and only given back when the store goes away, so a
+ * node never touches the allocator per key. A rebuild keeps the old array
+ * as a spare, which the next rebuild at that size takes instead of new
+ * memory; a steady put/delete mix rebuilding at the same size thus swaps
+ * between two arrays. With the arrays outgrown on the way up, the slot
+ * arrays take at most four times the current table.
+ */
+class KVStore {
+public:
+    typedef int64_t Key;
+    typedef pair<Key, int32_t> Entry;   // a key and the size of its value
+
+    // a store with room for initialSlots keys before the first rebuild
+    // (rounded up to a power of two), drawing on arena blocks of at least
+    // blockSize bytes
+    KVStore (size_t initialSlots = 1024, size_t blockSize = 1 << 20);
+    ~KVStore (void);
+
+    // size of the value of a key; false if there is none
+    bool get (Key key, int32_t &size) const;
+
+    // store a value of the given size; true if it replaced one
+    bool put (Key key, int32_t size);
+
+    // remove a key; false if there was none
+    bool remove (Key key);
+
+    // append all keys and their sizes, in no particular order
+    void entries (vector<Entry> &out) const;
+
+    // number of keys and the total size of their values
+    size_t size (void) const { return this->live_; }
+    int64_t bytes (void) const { return this->bytes_; }
+
+    // number of slots of the table and the memory held by the arena
+    size_t capacity (void) const { return this->capacity_; }
+    size_t arena_bytes (void) const { return this->arenaBytes_; }
+
+private:
+    enum SlotState { EMPTY = 0, FULL, DELETED };
+
+    struct Slot {
+        Key key;
+        int32_t size;
+        uint8_t state;
+    };
+
+    KVStore (const KVStore &);              // not copyable
+    KVStore &operator= (const KVStore &);
+
+    // memory for n zeroed slots from the arena
+    Slot *allocate (size_t n);
+
+    // the slot holding key, or nullptr
+    Slot *find (Key key) const;
+
+    // rebuild the table with the given number of slots
+    void rehash (size_t newCapacity);
+
+    static size_t hash (Key key);
+
+    Slot *slots_;           // the table
+    size_t capacity_;       // its number of slots, a power of two
+    size_t live_;           // slots holding a key
+    size_t deleted_;        // tombstones
+    int64_t bytes_;         // total size of the values
+
+    vector<char *> blocks_; // the arena's blocks
+    size_t blockSize_;      // minimum size of a block
+    char *next_;            // next free byte of the current block
+    size_t left_;           // bytes left in it
+    size_t arenaBytes_;     // bytes held in all blocks
+    Slot *spare_;           // the array before the last rebuild
+    size_t spareCapacity_;  // and its number of slots
+};
+
+#endif /* CS6381_CHORD_P2P_KVSTORE_H_ */
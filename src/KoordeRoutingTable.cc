@@ -0,0 +1,222 @@
+/*
+ * KoordeRoutingTable.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <set>
+
+#include "KoordeRoutingTable.h"
+
+KoordeRoutingTable::KoordeRoutingTable (RoutingTable::Owner *owner, const Helper::IDVector &ring,
+                                        int m, int degree)
+    : RoutingTable (owner, ring, m),
+      tables_ (),
+      degree_ (degree),
+      digitBits_ (0),
+      mask_ (this->keySpace_ - 1)
+{
+    while ((1 << this->digitBits_) < degree)
+        this->digitBits_++;
+    if (degree < 2 || (1 << this->digitBits_) != degree || m % this->digitBits_ != 0)
+        throw cRuntimeError ("KoordeRoutingTable -- the degree must be 2^d with d dividing m = %d, not %d",
+                             m, degree);
+}
+
+void KoordeRoutingTable::build (const Helper::IDVector &vnodes)
+{
+    // A lookup whose imaginary node is i in (v, s] moves on to the
+    // predecessor of k * i + j, so we need the predecessors of everything in
+    // [k * (v + 1), k * s + k - 1]: the predecessor of the low end and the
+    // nodes up to the high end.
+    size_t n = this->ring_.size ();
+    this->tables_.clear ();
+    for (Helper::IDVector::const_iterator vit = vnodes.begin (); vit != vnodes.end (); ++vit) {
+        KoordeRoutingTable::Table t;
+        t.id = *vit;
+        t.successor = this->successor ((t.id + 1) % this->keySpace_);
+
+        Helper::NodeID low = ((t.id + 1) * this->degree_) & this->mask_;
+        Helper::NodeID span = (this->distance (t.id, t.successor) - 1) * this->degree_ + this->degree_ - 1;
+        size_t pos = this->position (this->predecessor (low));
+        t.deBruijn.push_back (this->ring_[pos]);
+        for (size_t k = 1; k < n; ++k) {
+            Helper::NodeID e = this->ring_[(pos + k) % n];
+            if (span < this->keySpace_ && this->distance (low, e) > span)
+                break;
+            t.deBruijn.push_back (e);
+        }
+
+        EV << "=== KoordeRoutingTable::build NodeID: " << t.id
+           << " successor = " << t.successor
+           << ", " << t.deBruijn.size () << " de Bruijn pointers from " << t.deBruijn[0] << endl;
+        this->tables_.push_back (t);
+    }
+    this->built_ = true;
+}
+
+int KoordeRoutingTable::table_at (Helper::NodeID i) const
+{
+    for (size_t v = 0; v < this->tables_.size (); ++v) {
+        if (Helper::in_interval (i, this->tables_[v].id, this->tables_[v].successor, true))
+            return v;
+    }
+    return -1;
+}
+
+void KoordeRoutingTable::start_lookup (Helper::NodeID key, Helper::NodeID &i, Helper::NodeID &shift) const
+{
+    // The best imaginary node keeps the high bits of one of our virtual
+    // nodes and ends in the first t digits of the key, for t as large as
+    // possible; the rest of the key is what is left to shift in. The
+    // successor itself always works, with the whole key left.
+    int digits = this->m_ / this->digitBits_;
+    i = this->tables_[0].successor;
+    shift = key;
+    for (int t = digits; t > 0; --t) {
+        int bits = t * this->digitBits_;
+        Helper::NodeID low = (bits < this->m_) ? (key >> (this->m_ - bits)) : key;
+        for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+            Helper::NodeID high = (bits < this->m_) ? ((tit->id >> bits) << bits) : 0;
+            Helper::NodeID step = (bits < this->m_) ? (((Helper::NodeID) 1) << bits) : 0;
+            Helper::NodeID candidates[2] = { high | low, ((high | low) + step) & this->mask_ };
+            for (int c = 0; c < 2; ++c) {
+                if (Helper::in_interval (candidates[c], tit->id, tit->successor, true)) {
+                    i = candidates[c];
+                    shift = (bits < this->m_) ? ((key << bits) & this->mask_) : 0;
+                    return;
+                }
+            }
+        }
+    }
+}
+
+Helper::NodeID KoordeRoutingTable::next_hop (Helper::NodeID key, Lookup_Req *req)
+{
+    Helper::NodeID i = req->getRouteImaginary ();
+    Helper::NodeID shift = req->getRouteShift ();
+    if (i == KoordeRoutingTable::DETOUR)
+        return this->detour (key, req);
+    if (i < 0)
+        this->start_lookup (key, i, shift);
+
+    // de Bruijn hops that land on one of our own virtual nodes are taken
+    // right here; every pass shifts in a digit, so this ends
+    int limit = this->m_ / this->digitBits_ + this->tables_.size () + 1;
+    for (int pass = 0; pass < limit; ++pass) {
+        int v = this->table_at (i);
+        if (v < 0) {
+            // the imaginary node is not with us (we were reached by a
+            // successor hop): walk on towards it from the closest of our
+            // virtual nodes before it, or from any pointer of ours in
+            // between should we suspect that successor. A virtual node at i
+            // itself is not before it but a whole round away.
+            size_t u = 0;
+            for (size_t w = 1; w < this->tables_.size (); ++w) {
+                if (this->tables_[u].id == i
+                    || (this->tables_[w].id != i
+                        && this->distance (this->tables_[w].id, i) < this->distance (this->tables_[u].id, i)))
+                    u = w;
+            }
+            Helper::NodeID next = this->tables_[u].successor;
+            if (!this->usable (next))
+                next = this->closest_usable (i, this->distance (this->tables_[u].id, i));
+            if (next < 0)
+                return this->detour (key, req);
+            req->setRouteImaginary (i);
+            req->setRouteShift (shift);
+            return next;
+        }
+
+        const Table &t = this->tables_[v];
+        if (Helper::in_interval (key, t.id, t.successor, true))
+            return t.successor;
+
+        // shift the next digit of the key into the imaginary node and go to
+        // its predecessor, or to a pointer further before it if we suspect
+        // that one
+        int d = this->digitBits_;
+        i = ((i << d) | (shift >> (this->m_ - d))) & this->mask_;
+        shift = (shift << d) & this->mask_;
+
+        Helper::NodeID best = this->closest_pointer (t, i);
+        if (best < 0)
+            return this->detour (key, req);
+        if (!this->owner_->is_local (best)) {
+            req->setRouteImaginary (i);
+            req->setRouteShift (shift);
+            return best;
+        }
+    }
+
+    // not reached: the imaginary node is the key after m / d shifts
+    return this->tables_[0].successor;
+}
+
+Helper::NodeID KoordeRoutingTable::closest_pointer (const KoordeRoutingTable::Table &t, Helper::NodeID i) const
+{
+    // our own virtual nodes among the pointers take the hop right here
+    Helper::NodeID best = -1;
+    for (vector<Helper::NodeID>::const_iterator it = t.deBruijn.begin (); it != t.deBruijn.end (); ++it) {
+        if (!this->owner_->is_local (*it) && !this->usable (*it))
+            continue;
+        Helper::NodeID dist = this->distance (*it, i);
+        if (best < 0 || (dist != 0 && (this->distance (best, i) == 0 || dist < this->distance (best, i))))
+            best = *it;
+    }
+    return best;
+}
+
+Helper::NodeID KoordeRoutingTable::closest_usable (Helper::NodeID id, Helper::NodeID within) const
+{
+    Helper::NodeID best = -1;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        Helper::NodeID dist = this->distance (tit->successor, id);
+        if (this->usable (tit->successor) && dist != 0 && dist < within
+            && (best < 0 || dist < this->distance (best, id)))
+            best = tit->successor;
+        for (vector<Helper::NodeID>::const_iterator it = tit->deBruijn.begin (); it != tit->deBruijn.end (); ++it) {
+            dist = this->distance (*it, id);
+            if (this->usable (*it) && dist != 0 && dist < within
+                && (best < 0 || dist < this->distance (best, id)))
+                best = *it;
+        }
+    }
+    return best;
+}
+
+Helper::NodeID KoordeRoutingTable::detour (Helper::NodeID key, Lookup_Req *req)
+{
+    // Every hop of the detour gets closer to the key, so it cannot loop.
+    // Only if we suspect every pointer that does is the lookup left to the
+    // failure detector.
+    size_t u = 0;
+    for (size_t w = 1; w < this->tables_.size (); ++w) {
+        if (this->distance (this->tables_[w].id, key) < this->distance (this->tables_[u].id, key))
+            u = w;
+    }
+    Helper::NodeID next = this->closest_usable (key, this->distance (this->tables_[u].id, key));
+    req->setRouteImaginary (KoordeRoutingTable::DETOUR);
+    return (next >= 0) ? next : this->tables_[u].successor;
+}
+
+void KoordeRoutingTable::peers (Helper::IDVector &ids) const
+{
+    set<Helper::NodeID> seen;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        if (seen.insert (tit->successor).second)
+            ids.push_back (tit->successor);
+        for (vector<Helper::NodeID>::const_iterator it = tit->deBruijn.begin (); it != tit->deBruijn.end (); ++it) {
+            if (seen.insert (*it).second)
+                ids.push_back (*it);
+        }
+    }
+}
+
+size_t KoordeRoutingTable::state_size (void) const
+{
+    size_t n = 0;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit)
+        n += 1 + tit->deBruijn.size ();
+    return n;
+}
@@ -0,0 +1,81 @@
+/*
+ * KoordeRoutingTable.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_KOORDEROUTINGTABLE_H_
+#define CS6381_CHORD_P2P_KOORDEROUTINGTABLE_H_
+
+#include <vector>
+using namespace std;
+
+#include "RoutingTable.h"
+
+/**
+ * Koorde: routing on a de Bruijn graph embedded in the ring. With degree
+ * k = 2^d, node v keeps its successor and the nodes that precede the IDs
+ * k * i + j for all i in (v, successor(v)] and digits j < k, about k + 1 of
+ * them.
+ *
+ * A lookup carries an imaginary node i, an ID in (v, successor(v)] of the
+ * node v it is at, and the digits of the key still to be shifted into it.
+ * Each de Bruijn hop shifts the next base-k digit of the key into i and
+ * goes to the predecessor of the new i; after m / d shifts i is the key.
+ * The first node picks i so that it already ends in as many leading digits
+ * of the key as possible, which leaves O(log N / log k) hops.
+ *
+ * Pointers the chord node suspects of having failed are passed over for
+ * ones further back, from which successor hops lead on to the imaginary
+ * node. When no pointer is left that does, the lookup takes a detour: from
+ * then on every node sends it to the pointer that precedes the key most
+ * closely, as Chord does.
+ *
+ * The degree must be a power of two whose exponent divides m.
+ */
+class KoordeRoutingTable : public RoutingTable {
+public:
+    KoordeRoutingTable (Owner *owner, const Helper::IDVector &ring, int m, int degree);
+
+    virtual void build (const Helper::IDVector &vnodes) override;
+    virtual Helper::NodeID next_hop (Helper::NodeID key, Lookup_Req *req) override;
+    virtual void peers (Helper::IDVector &ids) const override;
+    virtual size_t state_size (void) const override;
+
+private:
+    // the pointers of one virtual node
+    struct Table {
+        Helper::NodeID id;
+        Helper::NodeID successor;
+        vector<Helper::NodeID> deBruijn;    // in ring order
+    };
+
+    // index of the virtual node whose (id, successor] holds i, or -1
+    int table_at (Helper::NodeID i) const;
+
+    // pick the first imaginary node for a lookup and the digits of the key
+    // left to shift in
+    void start_lookup (Helper::NodeID key, Helper::NodeID &i, Helper::NodeID &shift) const;
+
+    // the de Bruijn pointer of t that precedes i most closely, passing
+    // over the ones we suspect; -1 if we suspect them all
+    Helper::NodeID closest_pointer (const Table &t, Helper::NodeID i) const;
+
+    // the usable pointer of any of our virtual nodes that precedes id most
+    // closely and less than within before it, or -1
+    Helper::NodeID closest_usable (Helper::NodeID id, Helper::NodeID within) const;
+
+    // the next hop of a lookup that has given up on de Bruijn hops because
+    // of a suspect: the usable pointer that precedes the key most closely
+    Helper::NodeID detour (Helper::NodeID key, Lookup_Req *req);
+
+    // the routeImaginary of a lookup on such a detour
+    static const Helper::NodeID DETOUR = -2;
+
+    vector<Table> tables_;
+    int degree_;        // k
+    int digitBits_;     // d, with k = 2^d
+    Helper::NodeID mask_;   // 2^m - 1
+};
+
+#endif /* CS6381_CHORD_P2P_KOORDEROUTINGTABLE_H_ */
@@ -0,0 +1,157 @@
+/*
+ * LatencyMatrix.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+#include "LatencyMatrix.h"     // our header
+
+// register module with Omnet++
+Define_Module(LatencyMatrix);
+
+LatencyMatrix::LatencyMatrix ()
+    : cSimpleModule (),
+      numSites_ (0),
+      entries_ (),
+      sites_ (),
+      missingDelay_ (),
+      linksConfigured_ (0),
+      delaySum_ (0.0)
+{
+}
+
+void LatencyMatrix::initialize ()
+{
+    this->missingDelay_ = this->par ("missingDelay").doubleValue ();
+
+    string filename = this->par ("file").stdstringValue ();
+    if (filename.empty ()) {
+        EV << "=== LatencyMatrix::initialize: no matrix file, leaving link delays alone" << endl;
+        return;
+    }
+
+    this->load (filename);
+
+    // without routers the matrix only serves the overlay latency model
+    string routerVector = this->par ("routerVector").stdstringValue ();
+    if (!routerVector.empty ())
+        this->apply (routerVector.c_str ());
+
+    EV << "=== LatencyMatrix::initialize: " << this->numSites_ << " sites from " << filename
+       << ", set the delay of " << this->linksConfigured_ << " link directions" << endl;
+}
+
+void LatencyMatrix::handleMessage (cMessage *msg)
+{
+    throw cRuntimeError ("LatencyMatrix::handleMessage -- this module does not take messages");
+}
+
+void LatencyMatrix::finish ()
+{
+    recordScalar ("latencySites", this->numSites_);
+    recordScalar ("linksConfigured", this->linksConfigured_);
+    if (this->linksConfigured_ > 0)
+        recordScalar ("meanLinkDelay", this->delaySum_ / this->linksConfigured_);
+}
+
+void LatencyMatrix::load (const string &filename)
+{
+    ifstream in (filename);
+    if (!in.is_open ())
+        throw cRuntimeError ("LatencyMatrix::load -- cannot open %s", filename.c_str ());
+
+    // the file holds round trip times by default; we keep one-way delays
+    double scale = this->par ("entryUnit").doubleValue () * this->par ("oneWayFactor").doubleValue ();
+
+    string line;
+    while (getline (in, line)) {
+        if (line.empty () || line[0] == '#')
+            continue;
+
+        istringstream is (line);
+        double value;
+        int n = 0;
+        while (is >> value) {
+            this->entries_.push_back ((value < 0) ? -1.0f : (float) (value * scale));
+            ++n;
+        }
+        if (n == 0)
+            continue;
+        if (this->numSites_ == 0)
+            this->numSites_ = n;
+        else if (n != this->numSites_)
+            throw cRuntimeError ("LatencyMatrix::load -- row %d of %s has %d entries instead of %d",
+                                 (int) (this->entries_.size () / this->numSites_), filename.c_str (),
+                                 n, this->numSites_);
+    }
+
+    if (this->numSites_ == 0 || this->entries_.size () != (size_t) this->numSites_ * this->numSites_)
+        throw cRuntimeError ("LatencyMatrix::load -- %s is not a square matrix", filename.c_str ());
+}
+
+simtime_t LatencyMatrix::delay (int siteA, int siteB) const
+{
+    if (siteA == siteB)
+        return SIMTIME_ZERO;
+
+    // measurements are not always symmetric, and not always there
+    float d = this->entries_[(size_t) siteA * this->numSites_ + siteB];
+    if (d < 0)
+        d = this->entries_[(size_t) siteB * this->numSites_ + siteA];
+    return (d < 0) ? this->missingDelay_ : simtime_t (d);
+}
+
+void LatencyMatrix::apply (const char *routerVector)
+{
+    cModule *network = this->getParentModule ();
+    cModule *first = network->getSubmodule (routerVector, 0);
+    if (!first)
+        throw cRuntimeError ("LatencyMatrix::apply -- no router vector %s[] in %s",
+                             routerVector, network->getFullPath ().c_str ());
+
+    int numRouters = first->getVectorSize ();
+    if (numRouters > this->numSites_)
+        throw cRuntimeError ("LatencyMatrix::apply -- %d routers but only %d sites in the matrix",
+                             numRouters, this->numSites_);
+
+    // a random selection of distinct sites (a partial Fisher-Yates shuffle),
+    // drawn from our RNG so that the mapping changes with the seed
+    vector<int> pool (this->numSites_);
+    for (int s = 0; s < this->numSites_; ++s)
+        pool[s] = s;
+    for (int i = 0; i < numRouters; ++i) {
+        int j = this->intuniform (i, this->numSites_ - 1);
+        std::swap (pool[i], pool[j]);
+        this->sites_.push_back (pool[i]);
+    }
+
+    // set the delay of every point-to-point link between two of the routers.
+    // Each router sets its outgoing direction, so both directions get done.
+    for (int i = 0; i < numRouters; ++i) {
+        cModule *router = network->getSubmodule (routerVector, i);
+        for (int g = 0; g < router->gateSize ("pppg"); ++g) {
+            cGate *out = router->gate ("pppg$o", g);
+            cGate *next = out->getNextGate ();
+            if (!next)
+                continue;
+
+            cModule *peer = next->getOwnerModule ();
+            if (peer == nullptr || !peer->isVector () || strcmp (peer->getName (), routerVector) != 0)
+                continue;
+
+            cDatarateChannel *channel = dynamic_cast<cDatarateChannel *> (out->getChannel ());
+            if (!channel)
+                continue;
+
+            simtime_t d = this->delay (this->sites_[i], this->sites_[peer->getIndex ()]);
+            channel->setDelay (d.dbl ());
+            this->linksConfigured_++;
+            this->delaySum_ += d.dbl ();
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * LatencyMatrix.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_LATENCYMATRIX_H_
+#define CS6381_CHORD_P2P_LATENCYMATRIX_H_
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+/**
+ * Pairwise latencies between sites, read from a file in the layout of the
+ * King data set: one row of whitespace separated values per site, lines
+ * starting with '#' are comments and negative values mark missing
+ * measurements.
+ *
+ * Each router of the configured router vector is mapped to a distinct,
+ * randomly chosen site. The delay of every link between two such routers is
+ * then set from the matrix, so a network that meshes these routers sees the
+ * measured latencies between its sites (triangle inequality violations
+ * included).
+ */
+class LatencyMatrix : public cSimpleModule
+{
+public:
+    LatencyMatrix (void);
+
+    // one-way delay between two sites
+    simtime_t delay (int siteA, int siteB) const;
+
+    // number of sites in the matrix
+    int num_sites (void) const { return this->numSites_; }
+
+    // site the given router was mapped to
+    int site_of (int routerIndex) const { return this->sites_.at (routerIndex); }
+
+protected:
+    virtual void initialize (void) override;
+    virtual void handleMessage (cMessage *msg) override;
+    virtual void finish (void) override;
+
+private:
+    // read the matrix file
+    void load (const string &filename);
+
+    // map the routers to sites and set the delays of the links between them
+    void apply (const char *routerVector);
+
+    int numSites_;              // the matrix is numSites_ x numSites_
+    vector<float> entries_;     // the matrix, row by row, as one-way delays in seconds
+    vector<int> sites_;         // router index -> site
+    simtime_t missingDelay_;    // used where the matrix has no measurement
+    int linksConfigured_;       // number of link directions we set
+    double delaySum_;           // sum of the delays we set
+};
+
+#endif /* CS6381_CHORD_P2P_LATENCYMATRIX_H_ */
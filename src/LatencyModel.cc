@@ -0,0 +1,128 @@
+/*
+ * LatencyModel.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cmath>
+#include <string>
+using namespace std;
+
+#include "LatencyModel.h"      // our header
+#include "LatencyMatrix.h"     // pairwise site latencies
+
+// register module with Omnet++
+Define_Module(LatencyModel);
+
+LatencyModel::LatencyModel ()
+    : cSimpleModule (),
+      model_ (LatencyModel::EUCLIDEAN),
+      constantDelay_ (),
+      planeSize_ (0.0),
+      accessDelay_ (),
+      datarate_ (0.0),
+      jitter_ (0.0),
+      matrix_ (nullptr),
+      placementSeed_ (0),
+      numMessages_ (0),
+      delaySum_ (0.0)
+{
+}
+
+void LatencyModel::initialize ()
+{
+    string model = this->par ("model").stdstringValue ();
+    if (model == "constant")
+        this->model_ = LatencyModel::CONSTANT;
+    else if (model == "euclidean")
+        this->model_ = LatencyModel::EUCLIDEAN;
+    else if (model == "matrix")
+        this->model_ = LatencyModel::MATRIX;
+    else
+        throw cRuntimeError ("LatencyModel::initialize -- unknown latency model \"%s\"", model.c_str ());
+
+    this->constantDelay_ = this->par ("constantDelay").doubleValue ();
+    this->planeSize_ = this->par ("planeSize").doubleValue ();
+    this->accessDelay_ = this->par ("accessDelay").doubleValue ();
+    this->datarate_ = this->par ("datarate").doubleValue ();
+    this->jitter_ = this->par ("jitter").doubleValue ();
+    this->placementSeed_ = this->par ("placementSeed").longValue ();
+
+    if (this->model_ == LatencyModel::MATRIX) {
+        // with one latency model per partition, each uses the matrix of the same index
+        cModule *mod = this->getParentModule ()->getSubmodule (this->par ("matrixModule").stringValue (),
+                                                               this->isVector () ? this->getIndex () : -1);
+        this->matrix_ = dynamic_cast<LatencyMatrix *> (mod);
+        if (!this->matrix_)
+            throw cRuntimeError ("LatencyModel::initialize -- no LatencyMatrix module \"%s\"",
+                                 this->par ("matrixModule").stringValue ());
+    }
+
+    EV << "=== LatencyModel::initialize: model = " << model << endl;
+}
+
+void LatencyModel::handleMessage (cMessage *msg)
+{
+    throw cRuntimeError ("LatencyModel::handleMessage -- this module does not take messages");
+}
+
+void LatencyModel::finish ()
+{
+    recordScalar ("overlayMessages", this->numMessages_);
+    if (this->numMessages_ > 0)
+        recordScalar ("meanOverlayDelay", this->delaySum_ / this->numMessages_);
+}
+
+LatencyModel *LatencyModel::local (const char *name)
+{
+    cModule *network = getSimulation ()->getSystemModule ();
+    cModule *mod = network->getSubmodule (name, getSimulation ()->getParsimProcId ());
+    if (!mod)
+        mod = network->getSubmodule (name);
+    return dynamic_cast<LatencyModel *> (mod);
+}
+
+double LatencyModel::placement (int address, int salt) const
+{
+    // splitmix64 of the address, the purpose and our seed
+    uint64_t z = this->placementSeed_ + ((uint64_t) address << 8) + salt + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+simtime_t LatencyModel::delay (int fromAddress, int toAddress, int64_t byteLength)
+{
+    // called directly by the chord nodes and clients
+    Enter_Method_Silent ();
+
+    simtime_t d = this->base_delay (fromAddress, toAddress);
+    if (this->jitter_ > 0.0)
+        d += d * this->uniform (0.0, this->jitter_);
+    if (this->datarate_ > 0.0)
+        d += byteLength * 8 / this->datarate_;
+
+    this->numMessages_++;
+    this->delaySum_ += d.dbl ();
+    return d;
+}
+
+simtime_t LatencyModel::base_delay (int fromAddress, int toAddress)
+{
+    simtime_t d = this->accessDelay_ * 2;
+    if (this->model_ == LatencyModel::CONSTANT) {
+        d += this->constantDelay_;
+    } else if (this->model_ == LatencyModel::EUCLIDEAN) {
+        double dx = (this->placement (fromAddress, 0) - this->placement (toAddress, 0)) * this->planeSize_;
+        double dy = (this->placement (fromAddress, 1) - this->placement (toAddress, 1)) * this->planeSize_;
+        d += sqrt (dx * dx + dy * dy);
+    } else {
+        int n = this->matrix_->num_sites ();
+        if (n == 0)
+            throw cRuntimeError ("LatencyModel::base_delay -- the latency matrix has no sites");
+        d += this->matrix_->delay ((int) (this->placement (fromAddress, 2) * n),
+                                   (int) (this->placement (toAddress, 2) * n));
+    }
+    return d;
+}
@@ -0,0 +1,79 @@
+/*
+ * LatencyModel.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_LATENCYMODEL_H_
+#define CS6381_CHORD_P2P_LATENCYMODEL_H_
+
+#include <cstdint>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+class LatencyMatrix;
+
+/**
+ * End-to-end delay between two endpoints for the overlay transport, where
+ * chord nodes and clients hand messages to each other with sendDirect rather
+ * than going through the TCP/IP stack. Endpoints are identified by their
+ * overlay address (see Helper) and are placed by hashing it:
+ *
+ *   constant  -- every pair is constantDelay apart
+ *   euclidean -- endpoints get pseudo-random coordinates in a square of
+ *                side planeSize (in seconds); the delay is their distance
+ *   matrix    -- endpoints are mapped to pseudo-random sites of the
+ *                network's LatencyMatrix and get the delay between the sites
+ *
+ * Placing by hash rather than by drawing from the RNG means that the
+ * instances of the different partitions of a parallel run agree on where
+ * every endpoint is.
+ *
+ * Every message also pays accessDelay at both ends and, if a datarate is
+ * given, its serialization time. A jitter fraction adds a uniformly drawn
+ * random share on top.
+ */
+class LatencyModel : public cSimpleModule
+{
+public:
+    enum Model { CONSTANT, EUCLIDEAN, MATRIX };
+
+    LatencyModel (void);
+
+    // delay of a message of the given size from one endpoint to another
+    simtime_t delay (int fromAddress, int toAddress, int64_t byteLength);
+
+    // the part of the delay between two endpoints that does not vary from
+    // message to message, i.e., without jitter and serialization time. It
+    // serves as the distance for proximity based finger selection.
+    simtime_t base_delay (int fromAddress, int toAddress);
+
+    // the instance of our partition among the network's modules of that
+    // name (a vector with one per partition, or a single module)
+    static LatencyModel *local (const char *name);
+
+protected:
+    virtual void initialize (void) override;
+    virtual void handleMessage (cMessage *msg) override;
+    virtual void finish (void) override;
+
+private:
+    // a pseudo-random number in [0, 1) for the given endpoint and purpose
+    double placement (int address, int salt) const;
+
+    Model model_;               // which model we use
+    simtime_t constantDelay_;   // delay of the constant model
+    double planeSize_;          // side of the coordinate square, in seconds
+    simtime_t accessDelay_;     // delay added at each end
+    double datarate_;           // for the serialization delay; 0 means none
+    double jitter_;             // random extra as a fraction of the delay
+    LatencyMatrix *matrix_;     // for the matrix model
+    uint64_t placementSeed_;    // varies the placement of the endpoints
+
+    long numMessages_;          // number of delays handed out
+    double delaySum_;           // and their sum
+};
+
+#endif /* CS6381_CHORD_P2P_LATENCYMODEL_H_ */
@@ -0,0 +1,102 @@
+/*
+ * OverlayGateway.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ChordP2PMsg_m.h"     // the envelope
+#include "OverlayGateway.h"    // our header
+
+// register module with Omnet++
+Define_Module(OverlayGateway);
+
+OverlayGateway::OverlayGateway ()
+    : cSimpleModule (),
+      helper_ (nullptr),
+      lookahead_ (),
+      numLocal_ (0),
+      numForwarded_ (0),
+      numDelivered_ (0)
+{
+}
+
+OverlayGateway::~OverlayGateway ()
+{
+    if (this->helper_)
+        Helper::release ();
+}
+
+void OverlayGateway::initialize ()
+{
+    this->helper_ = Helper::acquire ();
+    this->lookahead_ = this->par ("lookahead").doubleValue ();
+
+    // we send to partition p on out[p], so there must be one of us per partition
+    int size = this->isVector () ? this->getVectorSize () : 1;
+    if (size != this->helper_->num_partitions ())
+        throw cRuntimeError ("OverlayGateway::initialize -- %d gateways for %d partitions",
+                             size, this->helper_->num_partitions ());
+
+    EV << "=== OverlayGateway::initialize: partition " << getSimulation ()->getParsimProcId ()
+       << " of " << this->helper_->num_partitions ()
+       << ", lookahead " << this->lookahead_ << endl;
+}
+
+void OverlayGateway::handleMessage (cMessage *msg)
+{
+    // an envelope from the gateway of another partition
+    Overlay_Envelope *env = check_and_cast<Overlay_Envelope *> (msg);
+    int moduleId = this->helper_->endpoint_module (env->getDestAddress ());
+    if (moduleId < 0)
+        throw cRuntimeError ("OverlayGateway::handleMessage -- endpoint %d is not in partition %d",
+                             env->getDestAddress (), getSimulation ()->getParsimProcId ());
+
+    cPacket *pkt = env->decapsulate ();
+    this->sendDirect (pkt, env->getRemainingDelay (), 0, getSimulation ()->getModule (moduleId), "directIn");
+    delete env;
+    this->numDelivered_++;
+}
+
+void OverlayGateway::finish ()
+{
+    recordScalar ("localDelivered", this->numLocal_);
+    recordScalar ("crossPartitionForwarded", this->numForwarded_);
+    recordScalar ("crossPartitionDelivered", this->numDelivered_);
+}
+
+void OverlayGateway::deliver (cPacket *msg, int destAddress, simtime_t delay)
+{
+    // called directly by the chord nodes and clients of our partition
+    Enter_Method_Silent ();
+    take (msg);
+
+    int moduleId = this->helper_->endpoint_module (destAddress);
+    if (moduleId >= 0) {
+        this->sendDirect (msg, delay, 0, getSimulation ()->getModule (moduleId), "directIn");
+        this->numLocal_++;
+        return;
+    }
+
+    if (this->helper_->num_partitions () == 1)
+        throw cRuntimeError ("OverlayGateway::deliver -- no endpoint with address %d", destAddress);
+    if (delay < this->lookahead_)
+        throw cRuntimeError ("OverlayGateway::deliver -- a delay of %s is shorter than the lookahead of %s; "
+                             "lower the lookahead or raise the latency model's accessDelay",
+                             delay.str ().c_str (), this->lookahead_.str ().c_str ());
+
+    Overlay_Envelope *env = new Overlay_Envelope (msg->getName ());
+    env->setDestAddress (destAddress);
+    env->setRemainingDelay (delay - this->lookahead_);
+    env->encapsulate (msg);
+    this->send (env, "out", this->helper_->partition_of (destAddress));
+    this->numForwarded_++;
+}
+
+OverlayGateway *OverlayGateway::local (const char *name)
+{
+    cModule *network = getSimulation ()->getSystemModule ();
+    cModule *mod = network->getSubmodule (name, getSimulation ()->getParsimProcId ());
+    if (!mod)
+        mod = network->getSubmodule (name);
+    return dynamic_cast<OverlayGateway *> (mod);
+}
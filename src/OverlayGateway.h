@@ -0,0 +1,52 @@
+/*
+ * OverlayGateway.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_OVERLAYGATEWAY_H_
+#define CS6381_CHORD_P2P_OVERLAYGATEWAY_H_
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+#include "Helper.h" // overlay addresses and partitions
+
+/**
+ * Delivers the messages of the overlay transport, also between the
+ * partitions of a parallel run. A message cannot be sent with sendDirect to
+ * a module in another partition, and the partitions can only run ahead of
+ * each other by the delay of the links between them. So there is one gateway
+ * per partition and the gateways are fully meshed with links of the
+ * lookahead delay. Chord nodes and clients hand every message to the gateway
+ * of their partition. It sends messages for local endpoints straight to
+ * them; the others go across to the gateway of the receiver's partition,
+ * which delivers them with whatever remains of the message's delay.
+ */
+class OverlayGateway : public cSimpleModule
+{
+public:
+    OverlayGateway (void);
+    virtual ~OverlayGateway (void);
+
+    // send a message to an endpoint, to arrive after the given delay. For an
+    // endpoint in another partition that must not be shorter than the lookahead.
+    void deliver (cPacket *msg, int destAddress, simtime_t delay);
+
+    // the gateway of our partition among the network's modules of that name
+    static OverlayGateway *local (const char *name);
+
+protected:
+    virtual void initialize (void) override;
+    virtual void handleMessage (cMessage *msg) override;
+    virtual void finish (void) override;
+
+private:
+    Helper *helper_;            // overlay addresses and partitions
+    simtime_t lookahead_;       // delay of the links between the gateways
+    long numLocal_;             // messages delivered within our partition
+    long numForwarded_;         // messages we sent to other partitions
+    long numDelivered_;         // messages from other partitions we delivered
+};
+
+#endif /* CS6381_CHORD_P2P_OVERLAYGATEWAY_H_ */
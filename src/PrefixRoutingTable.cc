@@ -0,0 +1,155 @@
+/*
+ * PrefixRoutingTable.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <set>
+
+#include "PrefixRoutingTable.h"
+
+PrefixRoutingTable::PrefixRoutingTable (RoutingTable::Owner *owner, const Helper::IDVector &ring,
+                                        int m, int bits)
+    : RoutingTable (owner, ring, m),
+      tables_ (),
+      bits_ (bits),
+      rows_ (0)
+{
+    if (bits < 1 || bits > m || bits > 16)
+        throw cRuntimeError ("PrefixRoutingTable -- prefixBits must be in [1, min(m, 16)], not %d", bits);
+    this->rows_ = (m + bits - 1) / bits;
+}
+
+int PrefixRoutingTable::digit_shift (int r) const
+{
+    int shift = this->m_ - (r + 1) * this->bits_;
+    return (shift < 0) ? 0 : shift;
+}
+
+int PrefixRoutingTable::digit_width (int r) const
+{
+    return this->m_ - r * this->bits_ - this->digit_shift (r);
+}
+
+int PrefixRoutingTable::digit (Helper::NodeID id, int r) const
+{
+    return (id >> this->digit_shift (r)) & ((1 << this->digit_width (r)) - 1);
+}
+
+int PrefixRoutingTable::shared_digits (Helper::NodeID a, Helper::NodeID b) const
+{
+    int r = 0;
+    while (r < this->rows_ && this->digit (a, r) == this->digit (b, r))
+        r++;
+    return r;
+}
+
+void PrefixRoutingTable::build (const Helper::IDVector &vnodes)
+{
+    // entry [r][c] is the first node of the ID range that starts with our
+    // first r digits followed by c, if that range has any node at all
+    this->tables_.clear ();
+    for (Helper::IDVector::const_iterator vit = vnodes.begin (); vit != vnodes.end (); ++vit) {
+        PrefixRoutingTable::Table t;
+        t.id = *vit;
+        t.successor = this->successor ((t.id + 1) % this->keySpace_);
+        size_t filled = 0;
+        for (int r = 0; r < this->rows_; ++r) {
+            int shift = this->digit_shift (r);
+            int above = this->m_ - r * this->bits_;     // bits below our first r digits
+            Helper::NodeID prefix = (t.id >> above) << above;
+            Helper::NodeID span = ((Helper::NodeID) 1) << shift;
+            vector<Helper::NodeID> row (1 << this->digit_width (r), -1);
+            for (int c = 0; c < (int) row.size (); ++c) {
+                if (c == this->digit (t.id, r))
+                    continue;   // our own range; the next row covers it
+                Helper::NodeID start = prefix | (((Helper::NodeID) c) << shift);
+                Helper::NodeID node = this->successor (start);
+                if (node >= start && node - start < span) {
+                    row[c] = node;
+                    filled++;
+                }
+            }
+            t.rows.push_back (row);
+        }
+
+        EV << "=== PrefixRoutingTable::build NodeID: " << t.id
+           << " successor = " << t.successor
+           << ", " << filled << " entries in " << this->rows_ << " rows" << endl;
+        this->tables_.push_back (t);
+    }
+    this->built_ = true;
+}
+
+Helper::NodeID PrefixRoutingTable::next_hop (Helper::NodeID key, Lookup_Req *)
+{
+    // the virtual node sharing the longest prefix with the key, and the one
+    // closest to it on the ring
+    size_t best = 0, closest = 0;
+    int shared = -1;
+    for (size_t v = 0; v < this->tables_.size (); ++v) {
+        int s = this->shared_digits (this->tables_[v].id, key);
+        if (s > shared) {
+            shared = s;
+            best = v;
+        }
+        if (this->distance (this->tables_[v].id, key) < this->distance (this->tables_[closest].id, key))
+            closest = v;
+    }
+    Helper::NodeID limit = this->distance (this->tables_[closest].id, key);
+
+    // fix the next digit when that gets us closer
+    if (shared < this->rows_) {
+        Helper::NodeID entry = this->tables_[best].rows[shared][this->digit (key, shared)];
+        if (entry >= 0 && this->usable (entry) && this->distance (entry, key) < limit)
+            return entry;
+    }
+
+    // otherwise the node we know of that precedes the key most closely. The
+    // successor of our closest virtual node does; the caller has made sure
+    // that it is not the owner's predecessor already.
+    Helper::NodeID next = this->tables_[closest].successor;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        if (this->usable (tit->successor)
+            && this->distance (tit->successor, key) < this->distance (next, key))
+            next = tit->successor;
+        for (vector<vector<Helper::NodeID> >::const_iterator rit = tit->rows.begin (); rit != tit->rows.end (); ++rit) {
+            for (vector<Helper::NodeID>::const_iterator it = rit->begin (); it != rit->end (); ++it) {
+                if (*it >= 0 && this->usable (*it)
+                    && this->distance (*it, key) < this->distance (next, key))
+                    next = *it;
+            }
+        }
+    }
+    return next;
+}
+
+void PrefixRoutingTable::peers (Helper::IDVector &ids) const
+{
+    set<Helper::NodeID> seen;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        if (seen.insert (tit->successor).second)
+            ids.push_back (tit->successor);
+        for (vector<vector<Helper::NodeID> >::const_iterator rit = tit->rows.begin (); rit != tit->rows.end (); ++rit) {
+            for (vector<Helper::NodeID>::const_iterator it = rit->begin (); it != rit->end (); ++it) {
+                if (*it >= 0 && seen.insert (*it).second)
+                    ids.push_back (*it);
+            }
+        }
+    }
+}
+
+size_t PrefixRoutingTable::state_size (void) const
+{
+    size_t n = 0;
+    for (vector<Table>::const_iterator tit = this->tables_.begin (); tit != this->tables_.end (); ++tit) {
+        n++;    // the successor
+        for (vector<vector<Helper::NodeID> >::const_iterator rit = tit->rows.begin (); rit != tit->rows.end (); ++rit) {
+            for (vector<Helper::NodeID>::const_iterator it = rit->begin (); it != rit->end (); ++it) {
+                if (*it >= 0)
+                    n++;
+            }
+        }
+    }
+    return n;
+}
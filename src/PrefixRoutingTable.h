@@ -0,0 +1,61 @@
+/*
+ * PrefixRoutingTable.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_PREFIXROUTINGTABLE_H_
+#define CS6381_CHORD_P2P_PREFIXROUTINGTABLE_H_
+
+#include <vector>
+using namespace std;
+
+#include "RoutingTable.h"
+
+/**
+ * Pastry-style prefix routing. IDs are read as ceil(m / b) digits of b
+ * bits, the most significant first (the last one shorter if b does not
+ * divide m). Row r of a virtual node's table has an entry for every value
+ * of digit r: the first node whose ID shares the node's first r digits and
+ * has that value as digit r, or none if there is no such node.
+ *
+ * A lookup goes to the entry for the key's digit in the row of the first
+ * digit where the key and the closest of our virtual nodes differ, which
+ * fixes one more digit per hop. When that entry is empty or is past the
+ * key, it goes to the node we know of that precedes the key most closely,
+ * successors included (a one-entry leaf set), so every hop gets closer to
+ * the key on the ring and the lookup cannot loop.
+ */
+class PrefixRoutingTable : public RoutingTable {
+public:
+    PrefixRoutingTable (Owner *owner, const Helper::IDVector &ring, int m, int bits);
+
+    virtual void build (const Helper::IDVector &vnodes) override;
+    virtual Helper::NodeID next_hop (Helper::NodeID key, Lookup_Req *req) override;
+    virtual void peers (Helper::IDVector &ids) const override;
+    virtual size_t state_size (void) const override;
+
+private:
+    // the table of one virtual node; -1 marks an empty entry
+    struct Table {
+        Helper::NodeID id;
+        Helper::NodeID successor;
+        vector<vector<Helper::NodeID> > rows;
+    };
+
+    // bits below digit r, and the width of digit r
+    int digit_shift (int r) const;
+    int digit_width (int r) const;
+
+    // digit r of an ID
+    int digit (Helper::NodeID id, int r) const;
+
+    // number of leading digits two IDs share
+    int shared_digits (Helper::NodeID a, Helper::NodeID b) const;
+
+    vector<Table> tables_;
+    int bits_;      // b
+    int rows_;      // number of digits
+};
+
+#endif /* CS6381_CHORD_P2P_PREFIXROUTINGTABLE_H_ */
@@ -0,0 +1,238 @@
+/*
+ * ResultWriter.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstring>
+#include <sstream>
+using namespace std;
+
+#include "ResultWriter.h"     // our header
+
+// magic bytes at the start of a binary record file
+static const char BINARY_MAGIC[8] = { 'C', 'H', 'R', 'D', 'R', 'T', 'T', '\0' };
+static const uint32_t BINARY_VERSION = 1;
+
+// size of the binary file header: magic, version, simtime scale exponent
+static const size_t BINARY_HEADER_SIZE = sizeof (BINARY_MAGIC) + 2 * sizeof (uint32_t);
+
+ResultWriter::ResultWriter (const string &basename, Format format, size_t batchSize)
+    : basename_ (basename),
+      format_ (format),
+      batchSize_ (batchSize > 0 ? batchSize : 1),
+      recordFile_ (),
+      indexFile_ (),
+      records_ (),
+      index_ (),
+      open_ (false),
+      clientNames_ (),
+      clientIndex_ (),
+      nextSeq_ (),
+      batch_ (),
+      numRecords_ (0)
+{
+    this->recordFile_ = basename + ((format == BINARY) ? "-rtt.bin" : "-rtt.csv");
+    this->indexFile_ = basename + "-rtt.idx";
+    this->batch_.reserve (this->batchSize_);
+}
+
+ResultWriter::~ResultWriter (void)
+{
+    this->close ();
+}
+
+ResultWriter::Format ResultWriter::parse_format (const string &name)
+{
+    if (name == "csv")
+        return ResultWriter::CSV;
+    else if (name == "binary")
+        return ResultWriter::BINARY;
+
+    throw cRuntimeError ("ResultWriter::parse_format -- unknown result format \"%s\"",
+                         name.c_str ());
+}
+
+void ResultWriter::open (void)
+{
+    if (this->open_)
+        return;
+
+    ios_base::openmode mode = fstream::out | fstream::trunc;
+    if (this->format_ == ResultWriter::BINARY)
+        mode |= fstream::binary;
+
+    this->records_.open (this->recordFile_, mode);
+    this->index_.open (this->indexFile_, fstream::out | fstream::trunc);
+    if (!this->records_.is_open () || !this->index_.is_open ())
+        throw cRuntimeError ("ResultWriter::open -- cannot open %s for writing",
+                             this->recordFile_.c_str ());
+
+    if (this->format_ == ResultWriter::BINARY) {
+        int32_t scaleExp = SimTime::getScaleExp ();
+        this->records_.write (BINARY_MAGIC, sizeof (BINARY_MAGIC));
+        this->records_.write ((const char *) &BINARY_VERSION, sizeof (BINARY_VERSION));
+        this->records_.write ((const char *) &scaleExp, sizeof (scaleExp));
+    } else {
+        this->records_ << "client,seq,sent,rtt" << endl;
+    }
+
+    this->open_ = true;
+    this->write_index_header ();
+}
+
+void ResultWriter::close (void)
+{
+    if (!this->open_)
+        return;
+
+    this->flush ();
+    this->records_.close ();
+    this->index_.close ();
+    this->open_ = false;
+}
+
+void ResultWriter::write_index_header (void)
+{
+    // the index is plain text; it is tiny compared to the record file
+    this->index_ << "# record index for " << this->recordFile_ << endl
+                 << "format " << ((this->format_ == ResultWriter::BINARY) ? "binary" : "csv") << endl
+                 << "scaleexp " << SimTime::getScaleExp () << endl
+                 << "recordsize " << ResultWriter::BINARY_RECORD_SIZE << endl
+                 << "# client <index> <name>" << endl
+                 << "# batch <offset> <count> <firstSent> <lastSent>" << endl;
+    this->index_.flush ();
+}
+
+uint32_t ResultWriter::client_index (const string &name)
+{
+    map<string, uint32_t>::iterator it = this->clientIndex_.find (name);
+    if (it != this->clientIndex_.end ())
+        return it->second;
+
+    uint32_t idx = this->clientNames_.size ();
+    this->clientNames_.push_back (name);
+    this->clientIndex_[name] = idx;
+
+    if (this->open_) {
+        this->index_ << "client " << idx << " " << name << endl;
+    }
+    return idx;
+}
+
+void ResultWriter::append (uint32_t clientIdx, simtime_t sent, simtime_t rtt)
+{
+    ResultWriter::Record rec;
+    rec.clientIdx = clientIdx;
+    rec.seq = this->nextSeq_[clientIdx]++;
+    rec.sentRaw = sent.raw ();
+    rec.rttRaw = rtt.raw ();
+
+    this->batch_.push_back (rec);
+    this->numRecords_++;
+
+    if (this->batch_.size () >= this->batchSize_)
+        this->flush ();
+}
+
+void ResultWriter::flush (void)
+{
+    if (!this->open_ || this->batch_.empty ())
+        return;
+
+    streamoff offset = this->records_.tellp ();
+
+    if (this->format_ == ResultWriter::BINARY) {
+        // serialize the whole batch into one buffer and write it in one go
+        vector<char> buf (this->batch_.size () * ResultWriter::BINARY_RECORD_SIZE);
+        char *p = buf.data ();
+        for (RecordVector::iterator it = this->batch_.begin (); it != this->batch_.end (); ++it) {
+            memcpy (p, &it->clientIdx, sizeof (it->clientIdx)); p += sizeof (it->clientIdx);
+            memcpy (p, &it->seq, sizeof (it->seq)); p += sizeof (it->seq);
+            memcpy (p, &it->sentRaw, sizeof (it->sentRaw)); p += sizeof (it->sentRaw);
+            memcpy (p, &it->rttRaw, sizeof (it->rttRaw)); p += sizeof (it->rttRaw);
+        }
+        this->records_.write (buf.data (), buf.size ());
+    } else {
+        ostringstream os;
+        for (RecordVector::iterator it = this->batch_.begin (); it != this->batch_.end (); ++it) {
+            os << this->clientNames_[it->clientIdx] << ","
+               << it->seq << ","
+               << SimTime::fromRaw (it->sentRaw) << ","
+               << SimTime::fromRaw (it->rttRaw) << "\n";
+        }
+        this->records_ << os.str ();
+    }
+    this->records_.flush ();
+
+    this->index_ << "batch " << offset
+                 << " " << this->batch_.size ()
+                 << " " << SimTime::fromRaw (this->batch_.front ().sentRaw)
+                 << " " << SimTime::fromRaw (this->batch_.back ().sentRaw) << endl;
+
+    this->batch_.clear ();
+}
+
+void ResultWriter::read_records (RecordVector &rv)
+{
+    if (this->format_ == ResultWriter::BINARY) {
+        ifstream in (this->recordFile_, ifstream::binary);
+        in.seekg (BINARY_HEADER_SIZE);
+        char buf[ResultWriter::BINARY_RECORD_SIZE];
+        while (in.read (buf, sizeof (buf))) {
+            ResultWriter::Record rec;
+            const char *p = buf;
+            memcpy (&rec.clientIdx, p, sizeof (rec.clientIdx)); p += sizeof (rec.clientIdx);
+            memcpy (&rec.seq, p, sizeof (rec.seq)); p += sizeof (rec.seq);
+            memcpy (&rec.sentRaw, p, sizeof (rec.sentRaw)); p += sizeof (rec.sentRaw);
+            memcpy (&rec.rttRaw, p, sizeof (rec.rttRaw));
+            rv.push_back (rec);
+        }
+    } else {
+        ifstream in (this->recordFile_);
+        string line;
+        getline (in, line);    // skip the column header
+        while (getline (in, line)) {
+            istringstream is (line);
+            string name, seq, sent, rtt;
+            if (!getline (is, name, ',') || !getline (is, seq, ',')
+                    || !getline (is, sent, ',') || !getline (is, rtt))
+                continue;
+            ResultWriter::Record rec;
+            rec.clientIdx = this->client_index (name);
+            rec.seq = stoul (seq);
+            rec.sentRaw = SimTime::parse (sent.c_str ()).raw ();
+            rec.rttRaw = SimTime::parse (rtt.c_str ()).raw ();
+            rv.push_back (rec);
+        }
+    }
+}
+
+void ResultWriter::export_csv (const string &filename, uint64_t skipRecords)
+{
+    // make sure everything we have is on disk before reading it back
+    if (this->open_) {
+        this->flush ();
+    }
+
+    ResultWriter::RecordVector rv;
+    this->read_records (rv);
+
+    // group the RTTs per client, ordered by client name like the old
+    // map-based dump did
+    map<string, vector<int64_t> > perClient;
+    for (uint64_t i = skipRecords; i < rv.size (); ++i) {
+        perClient[this->clientNames_[rv[i].clientIdx]].push_back (rv[i].rttRaw);
+    }
+
+    fstream fs;
+    fs.open (filename, std::fstream::out);
+    for (map<string, vector<int64_t> >::iterator it = perClient.begin (); it != perClient.end (); ++it) {
+        fs << it->first;
+        for (vector<int64_t>::iterator rit = it->second.begin (); rit != it->second.end (); ++rit) {
+            fs << ", " << SimTime::fromRaw (*rit);
+        }
+        fs << endl;
+    }
+    fs.close ();
+}
@@ -0,0 +1,109 @@
+/*
+ * ResultWriter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_RESULTWRITER_H_
+#define CS6381_CHORD_P2P_RESULTWRITER_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+/**
+ * Incremental sink for the per-request RTT records collected by the
+ * Coordinator. Records are buffered and appended to the result file every
+ * "batch size" records, so a run that is aborted still leaves everything up to
+ * the last batch on disk and we never hold the full result set in memory.
+ *
+ * Two record formats are supported:
+ *   CSV    -- <base>-rtt.csv, one "client,seq,sent,rtt" line per record
+ *   BINARY -- <base>-rtt.bin, a small header followed by fixed size records
+ *
+ * In both cases an index file <base>-rtt.idx is maintained alongside. It lists
+ * the client names (the binary records only carry the client index) and one
+ * line per flushed batch with its file offset, record count and time span so
+ * that post-processing can seek straight to a region of interest.
+ */
+class ResultWriter {
+public:
+    enum Format { CSV, BINARY };
+
+    // one RTT sample. Times are kept as raw simtime values so nothing is
+    // lost in a round trip through the file
+    struct Record {
+        uint32_t clientIdx;     // index into the client name table
+        uint32_t seq;           // per-client request sequence number
+        int64_t  sentRaw;       // raw simtime when the request was sent
+        int64_t  rttRaw;        // raw simtime of the round trip
+    };
+    typedef vector<Record> RecordVector;
+
+    // size of one record in the binary file
+    static const size_t BINARY_RECORD_SIZE = 24;
+
+    ResultWriter (const string &basename, Format format, size_t batchSize);
+
+    // closes (and hence flushes) the files if still open
+    ~ResultWriter (void);
+
+    // parse the format name used in the NED file
+    static Format parse_format (const string &name);
+
+    // open the record and index files, truncating any earlier run
+    void open (void);
+
+    // flush whatever is buffered and close the files. Safe to call twice.
+    void close (void);
+
+    // map a client name to its index, registering it in the index file the
+    // first time we see it
+    uint32_t client_index (const string &name);
+
+    // buffer one record; the batch is written once it is full
+    void append (uint32_t clientIdx, simtime_t sent, simtime_t rtt);
+
+    // write the buffered batch to disk
+    void flush (void);
+
+    // number of records handed to us so far
+    uint64_t num_records (void) const { return this->numRecords_; }
+
+    // read the record file back and write it in the legacy layout, i.e., one
+    // "client, rtt, rtt, ..." line per client. The first skipRecords records
+    // (e.g., the warm-up period) are left out.
+    void export_csv (const string &filename, uint64_t skipRecords = 0);
+
+    // name of the file holding the records
+    const string &record_file (void) const { return this->recordFile_; }
+
+private:
+    void write_index_header (void);
+    void read_records (RecordVector &rv);
+
+    string  basename_;          // prefix of all files we create
+    Format  format_;            // record format
+    size_t  batchSize_;         // records per batch
+
+    string  recordFile_;        // <base>-rtt.csv or <base>-rtt.bin
+    string  indexFile_;         // <base>-rtt.idx
+    fstream records_;           // record stream
+    fstream index_;             // index stream
+    bool    open_;              // are the files open
+
+    vector<string>  clientNames_;           // client index -> name
+    map<string, uint32_t> clientIndex_;     // client name -> index
+    map<uint32_t, uint32_t> nextSeq_;       // client index -> next seq number
+
+    RecordVector  batch_;       // records not yet on disk
+    uint64_t numRecords_;       // records appended so far
+};
+
+#endif /* CS6381_CHORD_P2P_RESULTWRITER_H_ */
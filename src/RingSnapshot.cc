@@ -0,0 +1,117 @@
+/*
+ * RingSnapshot.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstring>
+#include <fstream>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+#include "RingSnapshot.h"     // our header
+
+// magic bytes at the start of a snapshot file
+static const char SNAPSHOT_MAGIC[8] = { 'C', 'H', 'R', 'D', 'S', 'N', 'A', 'P' };
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+// fixed-width fields
+template <typename T>
+static void put (ofstream &out, T v)
+{
+    out.write ((const char *) &v, sizeof (v));
+}
+
+template <typename T>
+static T get (ifstream &in, const string &path)
+{
+    T v;
+    if (!in.read ((char *) &v, sizeof (v)))
+        throw cRuntimeError ("RingSnapshot::read -- %s is truncated", path.c_str ());
+    return v;
+}
+
+RingSnapshot::RingSnapshot (void)
+    : m (0),
+      numVirtualNodes (0),
+      routingTable (),
+      hostIDs (),
+      hosts ()
+{
+}
+
+void RingSnapshot::write (const string &path) const
+{
+    ofstream out (path, ofstream::binary | ofstream::trunc);
+    if (!out)
+        throw cRuntimeError ("RingSnapshot::write -- cannot open %s", path.c_str ());
+
+    out.write (SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC));
+    put<uint32_t> (out, SNAPSHOT_VERSION);
+    put<uint32_t> (out, this->m);
+    put<uint32_t> (out, this->numVirtualNodes);
+    put<uint32_t> (out, this->hostIDs.size ());
+    put<uint32_t> (out, this->routingTable.size ());
+    out.write (this->routingTable.data (), this->routingTable.size ());
+    for (Helper::IDVector::const_iterator it = this->hostIDs.begin (); it != this->hostIDs.end (); ++it)
+        put<int64_t> (out, *it);
+
+    put<uint32_t> (out, this->hosts.size ());
+    for (HostMap::const_iterator hit = this->hosts.begin (); hit != this->hosts.end (); ++hit) {
+        put<uint32_t> (out, hit->first);
+        put<uint32_t> (out, hit->second.routing.size ());
+        for (Helper::IDVector::const_iterator it = hit->second.routing.begin ();
+             it != hit->second.routing.end (); ++it)
+            put<int64_t> (out, *it);
+        put<uint32_t> (out, hit->second.store.size ());
+        for (vector<KVStore::Entry>::const_iterator it = hit->second.store.begin ();
+             it != hit->second.store.end (); ++it) {
+            put<int64_t> (out, it->first);
+            put<int32_t> (out, it->second);
+        }
+    }
+
+    if (!out)
+        throw cRuntimeError ("RingSnapshot::write -- error writing %s", path.c_str ());
+}
+
+void RingSnapshot::read (const string &path)
+{
+    ifstream in (path, ifstream::binary);
+    if (!in)
+        throw cRuntimeError ("RingSnapshot::read -- cannot open %s", path.c_str ());
+
+    char magic[sizeof (SNAPSHOT_MAGIC)];
+    if (!in.read (magic, sizeof (magic)) || memcmp (magic, SNAPSHOT_MAGIC, sizeof (magic)) != 0)
+        throw cRuntimeError ("RingSnapshot::read -- %s is not a ring snapshot", path.c_str ());
+    uint32_t version = get<uint32_t> (in, path);
+    if (version != SNAPSHOT_VERSION)
+        throw cRuntimeError ("RingSnapshot::read -- %s has version %u, we read %u",
+                             path.c_str (), version, SNAPSHOT_VERSION);
+
+    this->m = get<uint32_t> (in, path);
+    this->numVirtualNodes = get<uint32_t> (in, path);
+    uint32_t numIDs = get<uint32_t> (in, path);
+    this->routingTable.assign (get<uint32_t> (in, path), '\0');
+    if (!in.read (&this->routingTable[0], this->routingTable.size ()))
+        throw cRuntimeError ("RingSnapshot::read -- %s is truncated", path.c_str ());
+    this->hostIDs.resize (numIDs);
+    for (uint32_t i = 0; i < numIDs; ++i)
+        this->hostIDs[i] = get<int64_t> (in, path);
+
+    this->hosts.clear ();
+    uint32_t numHosts = get<uint32_t> (in, path);
+    for (uint32_t h = 0; h < numHosts; ++h) {
+        RingSnapshot::HostState &hs = this->hosts[get<uint32_t> (in, path)];
+        hs.routing.resize (get<uint32_t> (in, path));
+        for (size_t i = 0; i < hs.routing.size (); ++i)
+            hs.routing[i] = get<int64_t> (in, path);
+        hs.store.resize (get<uint32_t> (in, path));
+        for (size_t i = 0; i < hs.store.size (); ++i) {
+            hs.store[i].first = get<int64_t> (in, path);
+            hs.store[i].second = get<int32_t> (in, path);
+        }
+    }
+}
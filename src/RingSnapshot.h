@@ -0,0 +1,61 @@
+/*
+ * RingSnapshot.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_RINGSNAPSHOT_H_
+#define CS6381_CHORD_P2P_RINGSNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+
+#include "Helper.h"     // node IDs
+#include "KVStore.h"    // stored keys
+
+/**
+ * The state of a converged ring, saved at the end of one run and loaded at
+ * the start of another so that lookups start against a warmed-up ring
+ * without repeating the set-up.
+ *
+ * It holds the ring itself (m, the virtual nodes per host and the node IDs
+ * in host order) and, per chord host, the state of its routing table as the
+ * table saved it and the keys of its store. The file is a small header
+ * followed by fixed-width integers in the byte order of the machine, like
+ * the binary result files:
+ *
+ *   "CHRDSNAP" version m numVirtualNodes numIDs  routingTable
+ *   numIDs x int64 node ID
+ *   numHosts, then per host:
+ *     hostIndex  numRoutingWords x int64  numKeys x (int64 key, int32 size)
+ *
+ * where strings and counts are a uint32 length or count followed by the
+ * data. A snapshot is only loaded into a run with the same ring and the same
+ * routing table.
+ */
+class RingSnapshot {
+public:
+    // what one chord host contributes
+    struct HostState {
+        Helper::IDVector routing;           // its routing table, as saved by it
+        vector<KVStore::Entry> store;       // the keys it stores
+    };
+    typedef map<int, HostState> HostMap;    // by host index
+
+    RingSnapshot (void);
+
+    // write the snapshot to a file / read it back; both throw on I/O errors
+    void write (const string &path) const;
+    void read (const string &path);
+
+    int m;                      // bits of the key space
+    int numVirtualNodes;        // virtual nodes per host
+    string routingTable;        // name of the routing table saved
+    Helper::IDVector hostIDs;   // node IDs in host order
+    HostMap hosts;
+};
+
+#endif /* CS6381_CHORD_P2P_RINGSNAPSHOT_H_ */
@@ -0,0 +1,54 @@
+/*
+ * RoutingTable.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <algorithm>
+
+#include "RoutingTable.h"
+#include "ChordRoutingTable.h"
+#include "KoordeRoutingTable.h"
+#include "PrefixRoutingTable.h"
+
+RoutingTable::RoutingTable (RoutingTable::Owner *owner, const Helper::IDVector &ring, int m)
+    : owner_ (owner),
+      ring_ (ring),
+      m_ (m),
+      keySpace_ (((Helper::NodeID) 1) << m),
+      built_ (false)
+{
+}
+
+RoutingTable *RoutingTable::create (const string &name, cComponent *node, RoutingTable::Owner *owner,
+                                    const Helper::IDVector &ring, int m)
+{
+    if (name == "chord")
+        return new ChordRoutingTable (owner, ring, m,
+                                      node->par ("fingerBits").longValue (),
+                                      node->par ("pnsCandidates").longValue (),
+                                      node->par ("routeSelection").stdstringValue (),
+                                      node->par ("prsHopWeight").doubleValue ());
+    if (name == "koorde")
+        return new KoordeRoutingTable (owner, ring, m, node->par ("koordeDegree").longValue ());
+    if (name == "prefix")
+        return new PrefixRoutingTable (owner, ring, m, node->par ("prefixBits").longValue ());
+    throw cRuntimeError ("RoutingTable::create -- unknown routing table \"%s\"", name.c_str ());
+}
+
+size_t RoutingTable::position (Helper::NodeID id) const
+{
+    size_t pos = std::lower_bound (this->ring_.begin (), this->ring_.end (), id) - this->ring_.begin ();
+    return (pos == this->ring_.size ()) ? 0 : pos;
+}
+
+Helper::NodeID RoutingTable::successor (Helper::NodeID id) const
+{
+    return this->ring_[this->position (id)];
+}
+
+Helper::NodeID RoutingTable::predecessor (Helper::NodeID id) const
+{
+    size_t pos = std::lower_bound (this->ring_.begin (), this->ring_.end (), id) - this->ring_.begin ();
+    return (pos == 0) ? this->ring_.back () : this->ring_[pos - 1];
+}
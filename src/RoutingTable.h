@@ -0,0 +1,128 @@
+/*
+ * RoutingTable.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_ROUTINGTABLE_H_
+#define CS6381_CHORD_P2P_ROUTINGTABLE_H_
+
+#include <string>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+#include "Helper.h"         // node IDs and the ring
+#include "ChordP2PMsg_m.h"  // lookups carry the routing state of some tables
+
+/**
+ * The routing state of a chord node: how a lookup for a key that none of
+ * the node's virtual nodes owns gets closer to its owner. The chord node
+ * itself takes care of the last hop, from the node just before the key to
+ * its successor, which is the owner whatever the table.
+ *
+ * One table covers all the virtual nodes of a host. The ring (the sorted
+ * list of all node IDs) is known up front, so tables are built in one go
+ * rather than by a join protocol. A table names the nodes it points to by
+ * ID; the chord node keeps the connections.
+ *
+ * The implementation is picked with the routingTable parameter of the
+ * chord node:
+ *
+ *   chord  -- finger tables (ChordRoutingTable), O(log_{2^b} N) hops
+ *             with fingers at base-2^b digits
+ *   koorde -- de Bruijn pointers of a given degree (KoordeRoutingTable),
+ *             O(log N / log degree) hops with O(degree) state
+ *   prefix -- Pastry-style prefix tables of 2^b columns
+ *             (PrefixRoutingTable), O(log_{2^b} N) hops
+ */
+class RoutingTable {
+public:
+    // what a table may ask of the chord node it routes for
+    class Owner {
+    public:
+        virtual ~Owner (void) {}
+
+        // is the ID one of the node's own virtual nodes
+        virtual bool is_local (Helper::NodeID nodeID) = 0;
+
+        // does the node suspect the host of a node of having failed
+        virtual bool is_suspect (Helper::NodeID nodeID) { return false; }
+
+        // round-trip time to the host of a node; negative if unknown
+        virtual simtime_t estimated_rtt (Helper::NodeID nodeID) = 0;
+
+        // mean of the RTTs the node measured; negative if none
+        virtual simtime_t mean_rtt (void) = 0;
+
+        // a successor table for the given offsets shared with the other
+        // nodes (see Helper::successor_table); null if there is none
+        virtual const Helper::IntVector *successor_table (const Helper::IDVector &offsets) { return nullptr; }
+    };
+
+    RoutingTable (Owner *owner, const Helper::IDVector &ring, int m);
+    virtual ~RoutingTable (void) {}
+
+    // the table named by the routingTable parameter of the given chord node
+    static RoutingTable *create (const string &name, cComponent *node, Owner *owner,
+                                 const Helper::IDVector &ring, int m);
+
+    // fill the table for the given virtual nodes (sorted by ID)
+    virtual void build (const Helper::IDVector &vnodes) = 0;
+
+    // has build been called
+    bool built (void) const { return this->built_; }
+
+    // the node a lookup for key goes to next. The key is owned neither by
+    // one of our virtual nodes nor by the successor of one. Tables that keep
+    // routing state in the lookup update it here.
+    virtual Helper::NodeID next_hop (Helper::NodeID key, Lookup_Req *req) = 0;
+
+    // the distinct nodes the table points to, our own virtual nodes included
+    virtual void peers (Helper::IDVector &ids) const = 0;
+
+    // the number of entries, summed over our virtual nodes
+    virtual size_t state_size (void) const = 0;
+
+    // record the table's own statistics with the chord node
+    virtual void record_scalars (cComponent *node) {}
+
+    // The state of the table as a list of words, for a ring snapshot, and
+    // the table filled from such a list instead of being built. A table that
+    // is cheap to build need not save anything; restore returns false then
+    // and the caller builds it.
+    virtual void save (Helper::IDVector &state) const {}
+    virtual bool restore (const Helper::IDVector &vnodes, const Helper::IDVector &state) { return false; }
+
+protected:
+    // first node at or after id on the ring
+    Helper::NodeID successor (Helper::NodeID id) const;
+
+    // last node before id on the ring
+    Helper::NodeID predecessor (Helper::NodeID id) const;
+
+    // index of the first node at or after id, wrapping to 0
+    size_t position (Helper::NodeID id) const;
+
+    // can a lookup go to the node: it is not one of our own virtual nodes
+    // and not one the owner suspects of having failed
+    bool usable (Helper::NodeID id) const
+    {
+        return !this->owner_->is_local (id) && !this->owner_->is_suspect (id);
+    }
+
+    // distance from one ID to another going clockwise
+    Helper::NodeID distance (Helper::NodeID from, Helper::NodeID to) const
+    {
+        return (to - from + this->keySpace_) % this->keySpace_;
+    }
+
+    Owner *owner_;
+    const Helper::IDVector &ring_;  // all node IDs, sorted
+    int m_;                         // bits of the key space
+    Helper::NodeID keySpace_;       // 2^m
+    bool built_;
+};
+
+#endif /* CS6381_CHORD_P2P_ROUTINGTABLE_H_ */
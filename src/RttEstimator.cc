@@ -0,0 +1,60 @@
+/*
+ * RttEstimator.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RttEstimator.h"
+
+RttEstimator::RttEstimator ()
+    : peers_ (),
+      numSamples_ (0)
+{
+}
+
+void RttEstimator::sample (int peer, simtime_t rtt)
+{
+    this->numSamples_++;
+
+    EstimateMap::iterator it = this->peers_.find (peer);
+    if (it == this->peers_.end ()) {
+        RttEstimator::Estimate e;
+        e.srtt = rtt;
+        e.rttvar = rtt / 2;
+        this->peers_[peer] = e;
+        return;
+    }
+
+    RttEstimator::Estimate &e = it->second;
+    simtime_t err = (e.srtt > rtt) ? e.srtt - rtt : rtt - e.srtt;
+    e.rttvar = e.rttvar * 0.75 + err * 0.25;
+    e.srtt = e.srtt * 0.875 + rtt * 0.125;
+}
+
+bool RttEstimator::has (int peer) const
+{
+    return this->peers_.find (peer) != this->peers_.end ();
+}
+
+simtime_t RttEstimator::srtt (int peer) const
+{
+    EstimateMap::const_iterator it = this->peers_.find (peer);
+    return (it != this->peers_.end ()) ? it->second.srtt : simtime_t (-1);
+}
+
+simtime_t RttEstimator::rttvar (int peer) const
+{
+    EstimateMap::const_iterator it = this->peers_.find (peer);
+    return (it != this->peers_.end ()) ? it->second.rttvar : simtime_t (-1);
+}
+
+simtime_t RttEstimator::mean () const
+{
+    if (this->peers_.empty ())
+        return simtime_t (-1);
+
+    double sum = 0.0;
+    for (EstimateMap::const_iterator it = this->peers_.begin (); it != this->peers_.end (); ++it)
+        sum += it->second.srtt.dbl ();
+    return sum / this->peers_.size ();
+}
@@ -0,0 +1,66 @@
+/*
+ * RttEstimator.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_RTTESTIMATOR_H_
+#define CS6381_CHORD_P2P_RTTESTIMATOR_H_
+
+#include <map>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+/**
+ * Smoothed round-trip times to the peers of a chord node, one estimate per
+ * peer host, kept the way TCP does (Jacobson/Karels):
+ *
+ *   srtt   <- (1 - alpha) srtt + alpha r
+ *   rttvar <- (1 - beta) rttvar + beta |srtt - r|
+ *
+ * with alpha = 1/8 and beta = 1/4. The first sample sets srtt to r and
+ * rttvar to r / 2.
+ *
+ * Samples come from the answers a node receives anyway, timed on the node's
+ * own clock: an answer (the response to a lookup we forwarded) echoes the
+ * timestamp the node put on what it answers, along with how long the
+ * answering node held that. The time since, less the holding time, is a
+ * round trip.
+ */
+class RttEstimator {
+public:
+    RttEstimator (void);
+
+    // add a round-trip sample for a peer
+    void sample (int peer, simtime_t rtt);
+
+    // do we have an estimate for the peer
+    bool has (int peer) const;
+
+    // smoothed RTT to the peer; negative if there is no sample yet
+    simtime_t srtt (int peer) const;
+
+    // its mean deviation; negative if there is no sample yet
+    simtime_t rttvar (int peer) const;
+
+    // mean of the smoothed RTTs over all peers; negative if there are none
+    simtime_t mean (void) const;
+
+    // number of peers with an estimate and of samples taken
+    int num_peers (void) const { return this->peers_.size (); }
+    long num_samples (void) const { return this->numSamples_; }
+
+private:
+    struct Estimate {
+        simtime_t srtt;
+        simtime_t rttvar;
+    };
+    typedef map<int, Estimate> EstimateMap;     // indexed by peer
+
+    EstimateMap peers_;
+    long numSamples_;
+};
+
+#endif /* CS6381_CHORD_P2P_RTTESTIMATOR_H_ */
@@ -0,0 +1,190 @@
+/*
+ * RunLengthControl.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+#include "RunLengthControl.h"     // our header
+
+// group size of the MSER-5 rule
+static const size_t MSER_GROUP = 5;
+
+// checks are never further apart than this many times checkInterval
+static const size_t MAX_CHECK_SPACING = 16;
+
+RunLengthControl::RunLengthControl (bool detectWarmup, double quantile, double confidence,
+                                    double relHalfWidth, int numBatches, int minBatchSize,
+                                    int checkInterval)
+    : detectWarmup_ (detectWarmup),
+      quantile_ (quantile),
+      confidence_ (confidence),
+      relHalfWidth_ (relHalfWidth),
+      numBatches_ (max (numBatches, 2)),
+      minBatchSize_ (max (minBatchSize, 1)),
+      checkInterval_ (max (checkInterval, 1)),
+      nextCheck_ (checkInterval_),
+      samples_ (),
+      groupMeans_ (),
+      groupSum_ (0.0),
+      warmup_ (0),
+      ciCenter_ (0.0),
+      ciHalfWidth_ (0.0),
+      converged_ (false)
+{
+}
+
+bool RunLengthControl::add_sample (double value)
+{
+    this->samples_.push_back (value);
+    this->groupSum_ += value;
+    if (this->samples_.size () % MSER_GROUP == 0) {
+        this->groupMeans_.push_back (this->groupSum_ / MSER_GROUP);
+        this->groupSum_ = 0.0;
+    }
+    if (this->samples_.size () < this->nextCheck_)
+        return false;
+
+    // the next check is a quarter of the series away, but at least
+    // checkInterval and at most MAX_CHECK_SPACING times that
+    size_t n = this->samples_.size ();
+    size_t spacing = min (max ((size_t) this->checkInterval_, n / 4), MAX_CHECK_SPACING * this->checkInterval_);
+    this->nextCheck_ = n + spacing;
+    return this->check ();
+}
+
+bool RunLengthControl::check (void)
+{
+    this->warmup_ = this->detectWarmup_ ? this->mser5 () : 0;
+    this->converged_ = false;
+
+    // we need enough samples after the warm-up for every batch to say
+    // something about the quantile
+    size_t steady = this->samples_.size () - this->warmup_;
+    size_t batchSize = steady / this->numBatches_;
+    if (batchSize < (size_t) this->minBatchSize_)
+        return false;
+
+    DoubleVector estimates;
+    DoubleVector batch;
+    for (int b = 0; b < this->numBatches_; ++b) {
+        SampleVector::const_iterator first = this->samples_.begin () + this->warmup_ + b * batchSize;
+        batch.assign (first, first + batchSize);
+        estimates.push_back (RunLengthControl::quantile (batch, this->quantile_));
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < estimates.size (); ++i)
+        sum += estimates[i];
+    double mean = sum / estimates.size ();
+
+    double ss = 0.0;
+    for (size_t i = 0; i < estimates.size (); ++i)
+        ss += (estimates[i] - mean) * (estimates[i] - mean);
+    double stddev = sqrt (ss / (estimates.size () - 1));
+
+    this->ciCenter_ = mean;
+    this->ciHalfWidth_ = RunLengthControl::t_critical (this->confidence_, estimates.size () - 1)
+                         * stddev / sqrt ((double) estimates.size ());
+    this->converged_ = (mean > 0.0) && (this->ciHalfWidth_ <= this->relHalfWidth_ * mean);
+    return this->converged_;
+}
+
+size_t RunLengthControl::mser5 (void) const
+{
+    // the series averaged in groups of five
+    const DoubleVector &means = this->groupMeans_;
+    size_t k = means.size ();
+    if (k < 2)
+        return 0;
+
+    // MSER(d) = sum_{i>=d} (Y_i - mean_d)^2 / (k-d)^2. With suffix sums of Y
+    // and Y^2 every d is evaluated in constant time. As usual we only look at
+    // truncating up to half of the series.
+    double sum = 0.0, sumsq = 0.0;
+    double best = -1.0;
+    size_t bestD = 0;
+    for (size_t d = k; d-- > 0; ) {
+        sum += means[d];
+        sumsq += means[d] * means[d];
+        if (d > k / 2)
+            continue;
+        double n = k - d;
+        double mser = (sumsq - sum * sum / n) / (n * n);
+        if (best < 0.0 || mser <= best) {
+            best = mser;
+            bestD = d;
+        }
+    }
+    return bestD * MSER_GROUP;
+}
+
+double RunLengthControl::steady_quantile (double q) const
+{
+    DoubleVector steady (this->samples_.begin () + this->warmup_, this->samples_.end ());
+    return RunLengthControl::quantile (steady, q);
+}
+
+double RunLengthControl::steady_mean (void) const
+{
+    size_t n = this->samples_.size () - this->warmup_;
+    if (n == 0)
+        return 0.0;
+
+    double sum = 0.0;
+    for (size_t i = this->warmup_; i < this->samples_.size (); ++i)
+        sum += this->samples_[i];
+    return sum / n;
+}
+
+double RunLengthControl::quantile (DoubleVector &dv, double q)
+{
+    if (dv.empty ())
+        return 0.0;
+
+    // interpolate between the order statistics around q (n - 1), so that
+    // the p99 of a batch of 100 is not simply its maximum
+    double h = q * (dv.size () - 1);
+    size_t lo = (size_t) h;
+    nth_element (dv.begin (), dv.begin () + lo, dv.end ());
+    double value = dv[lo];
+    if (lo + 1 < dv.size ())
+        value += (h - lo) * (*min_element (dv.begin () + lo + 1, dv.end ()) - value);
+    return value;
+}
+
+double RunLengthControl::t_critical (double confidence, int dof)
+{
+    // the normal quantile for 1 - alpha/2 by Acklam's rational approximation
+    double p = 1.0 - (1.0 - confidence) / 2.0;
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    double z;
+    if (p > 0.97575) {
+        double q = sqrt (-2.0 * log (1.0 - p));
+        z = -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+            / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+    } else {
+        double q = p - 0.5;
+        double r = q * q;
+        z = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q
+            / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1.0);
+    }
+
+    // and its Cornish-Fisher expansion for the t distribution
+    double n = max (dof, 1);
+    double z2 = z * z;
+    return z
+        + z * (z2 + 1.0) / (4.0 * n)
+        + z * ((5.0 * z2 + 16.0) * z2 + 3.0) / (96.0 * n * n)
+        + z * (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) / (384.0 * n * n * n);
+}
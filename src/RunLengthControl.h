@@ -0,0 +1,99 @@
+/*
+ * RunLengthControl.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_RUNLENGTHCONTROL_H_
+#define CS6381_CHORD_P2P_RUNLENGTHCONTROL_H_
+
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+/**
+ * Decides how much of the RTT series to keep and when we have enough of it.
+ *
+ * The start-up transient (sockets being connected, finger tables being
+ * built) is cut off with the MSER-5 rule: the series is averaged in groups of
+ * five and we drop the prefix that minimizes the standard error of the rest.
+ *
+ * The remaining samples are split into a fixed number of batches and the
+ * requested quantile (the p99 by default) is estimated in each batch,
+ * interpolating between the samples around it. The batch estimates are
+ * treated as independent observations, which gives a Student-t confidence
+ * interval for the quantile. The run may stop once the
+ * half width of that interval is within the target fraction of its center.
+ *
+ * A check passes over the whole series, so checks are spaced out as it
+ * grows: a quarter of the series apart, but at least checkInterval and at
+ * most 16 checkInterval samples. A run thus goes on for at most that many
+ * samples past the point where it could have stopped. The group means of
+ * MSER-5 are kept as the samples come in, and the samples themselves in
+ * single precision, which is plenty for RTTs.
+ */
+class RunLengthControl {
+public:
+    typedef vector<double> DoubleVector;
+    typedef vector<float> SampleVector;
+
+    RunLengthControl (bool detectWarmup, double quantile, double confidence,
+                      double relHalfWidth, int numBatches, int minBatchSize,
+                      int checkInterval);
+
+    // add one RTT sample (in seconds). Returns true if this sample caused a
+    // check and the confidence interval is now narrow enough.
+    bool add_sample (double value);
+
+    // recompute the warm-up length and the confidence interval
+    bool check (void);
+
+    // number of samples seen so far
+    size_t num_samples (void) const { return this->samples_.size (); }
+
+    // number of leading samples that belong to the warm-up period
+    size_t warmup_length (void) const { return this->warmup_; }
+
+    // center and half width of the last computed confidence interval
+    double ci_center (void) const { return this->ciCenter_; }
+    double ci_half_width (void) const { return this->ciHalfWidth_; }
+
+    // was the target width reached at the last check
+    bool converged (void) const { return this->converged_; }
+
+    // the given quantile of the samples after the warm-up period
+    double steady_quantile (double q) const;
+
+    // mean of the samples after the warm-up period
+    double steady_mean (void) const;
+
+    // the q-quantile of the given values (which get reordered), interpolated
+    // linearly between order statistics
+    static double quantile (DoubleVector &dv, double q);
+
+    // two-sided Student-t critical value for the given confidence level
+    static double t_critical (double confidence, int dof);
+
+private:
+    // MSER-5 truncation point, in samples
+    size_t mser5 (void) const;
+
+    bool detectWarmup_;     // cut off the start-up transient
+    double quantile_;       // which quantile the stop rule is about
+    double confidence_;     // confidence level of the interval
+    double relHalfWidth_;   // target half width relative to the center
+    int numBatches_;        // number of batches for the batch estimates
+    int minBatchSize_;      // smallest batch that gives a usable estimate
+    int checkInterval_;     // fewest samples between two checks
+    size_t nextCheck_;      // number of samples at the next check
+
+    SampleVector samples_;  // all the samples in arrival order
+    DoubleVector groupMeans_;   // of every MSER_GROUP samples
+    double groupSum_;       // of the samples past the last full group
+    size_t warmup_;         // current warm-up length
+    double ciCenter_;       // last confidence interval
+    double ciHalfWidth_;
+    bool converged_;
+};
+
+#endif /* CS6381_CHORD_P2P_RUNLENGTHCONTROL_H_ */
@@ -0,0 +1,144 @@
+/*
+ * Trace.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+#include "Trace.h"     // our header
+
+// magic bytes at the start of a trace file
+static const char TRACE_MAGIC[8] = { 'C', 'H', 'R', 'D', 'T', 'R', 'C', 'E' };
+static const uint32_t TRACE_VERSION = 1;
+
+// the records go to the file as they are in memory
+static_assert (sizeof (TraceBuffer::Record) == 32, "trace records must be 32 bytes");
+
+// the names of the trace points, in the order of TraceEvent
+static const char *TRACE_EVENT_NAMES[TRACE_NUM_EVENTS] = {
+    "msgArrived",
+    "socketAccepted",
+    "socketEstablished",
+    "socketClosed",
+    "socketFailed",
+    "connect",
+    "connectStarted",
+    "udpIndication",
+    "lookupOwned",
+    "lookupForwarded",
+    "respDropped",
+    "storeOp",
+    "replicaApplied",
+    "requestSent",
+    "requestRetransmitted",
+    "requestFailed",
+    "respArrived",
+    "respLate",
+    "misrouted",
+    "peerSuspected",
+    "peerCleared",
+    "lookupRerouted"
+};
+
+TraceBuffer::TraceBuffer (void)
+    : level_ (TRACE_OFF),
+      wrap_ (false),
+      ring_ (),
+      next_ (0),
+      count_ (0),
+      numRecords_ (0),
+      numOverwritten_ (0),
+      file_ ()
+{
+}
+
+TraceBuffer::~TraceBuffer (void)
+{
+    this->close ();
+}
+
+const char *TraceBuffer::event_name (int event)
+{
+    return (event >= 0 && event < TRACE_NUM_EVENTS) ? TRACE_EVENT_NAMES[event] : "unknown";
+}
+
+void TraceBuffer::open (cComponent *module, int level, const string &basename,
+                        size_t capacity, bool wrap)
+{
+    this->close ();
+    if (level <= TRACE_OFF)
+        return;
+
+    string base = basename;
+    if (base.empty ())
+        base = getSimulation ()->getSystemModule ()->getFullName ();
+    string path = module->getFullPath ();
+    string filename = base + "-" + path + ".trace";
+
+    this->file_.open (filename, ofstream::out | ofstream::trunc | ofstream::binary);
+    if (!this->file_.is_open ())
+        throw cRuntimeError ("TraceBuffer::open -- cannot open %s for writing", filename.c_str ());
+
+    // the header, so that the decoder needs nothing but the file
+    int32_t scaleExp = SimTime::getScaleExp ();
+    uint32_t recordSize = sizeof (TraceBuffer::Record);
+    uint32_t numEvents = TRACE_NUM_EVENTS;
+    this->file_.write (TRACE_MAGIC, sizeof (TRACE_MAGIC));
+    this->file_.write ((const char *) &TRACE_VERSION, sizeof (TRACE_VERSION));
+    this->file_.write ((const char *) &scaleExp, sizeof (scaleExp));
+    this->file_.write ((const char *) &recordSize, sizeof (recordSize));
+    this->file_.write ((const char *) &numEvents, sizeof (numEvents));
+    for (int i = 0; i < TRACE_NUM_EVENTS; ++i) {
+        uint8_t len = strlen (TRACE_EVENT_NAMES[i]);
+        this->file_.write ((const char *) &len, sizeof (len));
+        this->file_.write (TRACE_EVENT_NAMES[i], len);
+    }
+    uint32_t pathLen = path.length ();
+    this->file_.write ((const char *) &pathLen, sizeof (pathLen));
+    this->file_.write (path.data (), pathLen);
+
+    this->level_ = level;
+    this->wrap_ = wrap;
+    this->ring_.assign (capacity > 0 ? capacity : 1, TraceBuffer::Record ());
+    this->next_ = 0;
+    this->count_ = 0;
+}
+
+void TraceBuffer::close (void)
+{
+    if (this->level_ == TRACE_OFF)
+        return;
+
+    this->drain ();
+    this->file_.close ();
+    this->level_ = TRACE_OFF;
+    vector<TraceBuffer::Record> ().swap (this->ring_);
+}
+
+void TraceBuffer::overflow (void)
+{
+    if (!this->wrap_) {
+        this->drain ();
+        return;
+    }
+
+    // the next record goes over the oldest one
+    this->count_--;
+    this->numOverwritten_++;
+}
+
+void TraceBuffer::drain (void)
+{
+    // the oldest record is count_ slots before the next one; the records
+    // wrap around the end of the ring at most once
+    size_t size = this->ring_.size ();
+    size_t first = (this->next_ + size - this->count_) % size;
+    size_t head = min (this->count_, size - first);
+    this->file_.write ((const char *) &this->ring_[first], head * sizeof (TraceBuffer::Record));
+    this->file_.write ((const char *) &this->ring_[0], (this->count_ - head) * sizeof (TraceBuffer::Record));
+    this->next_ = 0;
+    this->count_ = 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Trace.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_TRACE_H_
+#define CS6381_CHORD_P2P_TRACE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+// Trace points above this level are compiled out altogether. Build with
+// -DCHORD_TRACE_LEVEL=0 (e.g., via opp_makemake -D) for a binary without any.
+#ifndef CHORD_TRACE_LEVEL
+#define CHORD_TRACE_LEVEL 2
+#endif
+
+// record a trace point of the given level into a TraceBuffer if both the
+// build and the buffer's run-time level let it through
+#define CHORD_TRACE(buf, level, event, a, b)                              \
+    do {                                                                  \
+        if ((level) <= CHORD_TRACE_LEVEL && (buf).enabled (level))        \
+            (buf).record ((event), (level), (int64_t) (a), (int64_t) (b));\
+    } while (0)
+
+// levels of trace points, by how often they fire
+enum TraceLevel {
+    TRACE_OFF = 0,
+    TRACE_LOOKUP = 1,   // once per lookup or per connection
+    TRACE_MESSAGE = 2,  // once per message or socket callback
+    TRACE_DETAIL = 3    // anything finer
+};
+
+// the trace points; the names written into every trace file follow this order
+enum TraceEvent {
+    TRACE_MSG_ARRIVED,      // a: connection ID (-1 without one), b: bytes
+    TRACE_SOCKET_ACCEPTED,  // a: connection ID
+    TRACE_SOCKET_ESTABLISHED, // a: connection ID
+    TRACE_SOCKET_CLOSED,    // a: connection ID
+    TRACE_SOCKET_FAILED,    // a: connection ID, b: failure code
+    TRACE_CONNECT,          // a: node ID, b: 1 if the connect was deferred
+    TRACE_CONNECT_STARTED,  // a: connection ID, b: connects still deferred
+    TRACE_UDP_INDICATION,   // a: message kind
+    TRACE_LOOKUP_OWNED,     // a: key, b: answering node ID
+    TRACE_LOOKUP_FORWARDED, // a: key, b: next hop
+    TRACE_RESP_DROPPED,     // a: key
+    TRACE_STORE_OP,         // a: key, b: op * 2 + found
+    TRACE_REPLICA_APPLIED,  // a: key, b: op
+    TRACE_REQUEST_SENT,     // a: key, b: sequence number
+    TRACE_REQUEST_RETRANSMITTED, // a: key, b: retransmission
+    TRACE_REQUEST_FAILED,   // a: key, b: sequence number
+    TRACE_RESP_ARRIVED,     // a: key, b: hop count
+    TRACE_RESP_LATE,        // a: key, b: sequence number
+    TRACE_MISROUTED,        // a: key, b: answering node ID
+    TRACE_PEER_SUSPECTED,   // a: node ID, b: key of the lookup not acked
+    TRACE_PEER_CLEARED,     // a: host index
+    TRACE_LOOKUP_REROUTED,  // a: key, b: new next hop
+    TRACE_NUM_EVENTS
+};
+
+/**
+ * Per-module trace of fixed-size binary records. A trace point costs a level
+ * check when it is off and a 32 byte store into a preallocated ring of
+ * records when it is on; nothing is formatted while the simulation runs.
+ *
+ * The ring is written to the trace file whenever it fills up and when the
+ * buffer is closed. With wrap set it is never written while running:
+ * the oldest records are overwritten instead, so that only the last
+ * capacity records make it to the file.
+ *
+ * A trace file holds a header (magic, version, simtime scale exponent,
+ * record size, the names of the events and the module path) followed by
+ * the records; simulations/trace_decode.py turns it back into text.
+ */
+class TraceBuffer {
+public:
+    struct Record {
+        int64_t time;       // raw simtime
+        uint32_t event;
+        uint32_t level;
+        int64_t a;
+        int64_t b;
+    };
+
+    TraceBuffer (void);
+    ~TraceBuffer (void);
+
+    // start tracing the points of up to the given level. The file is
+    // basename + "-" + the module's full path + ".trace"; the network's
+    // name stands in for an empty basename. Level 0 leaves tracing off.
+    void open (cComponent *module, int level, const string &basename,
+               size_t capacity, bool wrap);
+
+    // write out what is left and stop tracing
+    void close (void);
+
+    bool enabled (int level) const { return level <= this->level_; }
+
+    void record (int event, int level, int64_t a, int64_t b)
+    {
+        if (this->count_ == this->ring_.size ())
+            this->overflow ();
+        Record &r = this->ring_[this->next_];
+        r.time = simTime ().raw ();
+        r.event = event;
+        r.level = level;
+        r.a = a;
+        r.b = b;
+        if (++this->next_ == this->ring_.size ())
+            this->next_ = 0;
+        this->count_++;
+        this->numRecords_++;
+    }
+
+    long num_records (void) const { return this->numRecords_; }
+    long num_overwritten (void) const { return this->numOverwritten_; }
+
+    // name of a trace point
+    static const char *event_name (int event);
+
+private:
+    // the ring is full: write it out, or make room for one more record
+    void overflow (void);
+
+    // write the records of the ring, oldest first, and empty it
+    void drain (void);
+
+    int level_;                 // run-time level, TRACE_OFF when closed
+    bool wrap_;
+    vector<Record> ring_;
+    size_t next_;               // where the next record goes
+    size_t count_;              // records in the ring
+    long numRecords_;
+    long numOverwritten_;
+    ofstream file_;
+};
+
+#endif /* CS6381_CHORD_P2P_TRACE_H_ */
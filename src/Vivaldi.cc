@@ -0,0 +1,123 @@
+/*
+ * Vivaldi.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cmath>
+using namespace std;
+
+#include "Vivaldi.h"     // our header
+
+// a height never goes below this, nor an error (seconds, relative)
+static const double VIVALDI_MIN_HEIGHT = 1e-5;
+static const double VIVALDI_MIN_ERROR = 1e-3;
+
+Vivaldi::Vivaldi (void)
+    : coord_ (),
+      error_ (1.0),
+      cc_ (0.25),
+      ce_ (0.25),
+      rng_ (nullptr),
+      peers_ (),
+      numSamples_ (0),
+      sampleErrorSum_ (0.0)
+{
+}
+
+void Vivaldi::init (int dimensions, double cc, double ce, cRNG *rng)
+{
+    if (dimensions < 1)
+        throw cRuntimeError ("Vivaldi::init -- need at least one dimension, not %d", dimensions);
+
+    this->coord_.assign (dimensions + 1, 0.0);
+    this->coord_[dimensions] = VIVALDI_MIN_HEIGHT;
+    this->error_ = 1.0;
+    this->cc_ = cc;
+    this->ce_ = ce;
+    this->rng_ = rng;
+}
+
+double Vivaldi::distance (const Vivaldi::Coord &a, const Vivaldi::Coord &b) const
+{
+    size_t dims = this->coord_.size () - 1;
+    double sq = 0.0;
+    for (size_t i = 0; i < dims; ++i)
+        sq += (a[i] - b[i]) * (a[i] - b[i]);
+    return sqrt (sq) + a[dims] + b[dims];
+}
+
+void Vivaldi::sample (int peer, simtime_t rtt, const Vivaldi::Coord &remote, double remoteError)
+{
+    if (!this->enabled () || remote.size () != this->coord_.size () || rtt <= SIMTIME_ZERO)
+        return;
+    this->learn (peer, remote, remoteError);
+
+    double r = rtt.dbl ();
+    double dist = this->distance (this->coord_, remote);
+    double relError = fabs (dist - r) / r;
+    this->numSamples_++;
+    this->sampleErrorSum_ += relError;
+
+    // the sample weighs by how sure we are of our place against the peer
+    double w = this->error_ / (this->error_ + remoteError);
+    this->error_ = relError * this->ce_ * w + this->error_ * (1.0 - this->ce_ * w);
+    if (this->error_ < VIVALDI_MIN_ERROR)
+        this->error_ = VIVALDI_MIN_ERROR;
+
+    // move along the line from the peer to us: away from it when the
+    // coordinates put us too close, towards it when too far. The heights
+    // move the same way as the positions.
+    size_t dims = this->coord_.size () - 1;
+    double force = this->cc_ * w * (r - dist);
+    double plane = dist - this->coord_[dims] - remote[dims];
+    if (plane > 0.0) {
+        for (size_t i = 0; i < dims; ++i)
+            this->coord_[i] += force * (this->coord_[i] - remote[i]) / dist;
+        this->coord_[dims] += force * (this->coord_[dims] + remote[dims]) / dist;
+    } else {
+        // in the same place as the peer: any direction will do
+        Vivaldi::Coord dir (dims);
+        double len = 0.0;
+        while (len == 0.0) {
+            len = 0.0;
+            for (size_t i = 0; i < dims; ++i) {
+                dir[i] = 2.0 * this->rng_->doubleRand () - 1.0;
+                len += dir[i] * dir[i];
+            }
+            len = sqrt (len);
+        }
+        for (size_t i = 0; i < dims; ++i)
+            this->coord_[i] += force * dir[i] / len;
+    }
+    if (this->coord_[dims] < VIVALDI_MIN_HEIGHT)
+        this->coord_[dims] = VIVALDI_MIN_HEIGHT;
+}
+
+void Vivaldi::learn (int peer, const Vivaldi::Coord &remote, double remoteError)
+{
+    if (!this->enabled () || remote.size () != this->coord_.size ())
+        return;
+
+    Vivaldi::Peer &p = this->peers_[peer];
+    p.coord = remote;
+    p.error = (remoteError < VIVALDI_MIN_ERROR) ? VIVALDI_MIN_ERROR : remoteError;
+}
+
+bool Vivaldi::knows (int peer) const
+{
+    return this->peers_.find (peer) != this->peers_.end ();
+}
+
+simtime_t Vivaldi::predict (int peer) const
+{
+    PeerMap::const_iterator it = this->peers_.find (peer);
+    return (it != this->peers_.end ()) ? this->predict (it->second.coord) : simtime_t (-1);
+}
+
+simtime_t Vivaldi::predict (const Vivaldi::Coord &remote) const
+{
+    if (!this->enabled () || remote.size () != this->coord_.size ())
+        return simtime_t (-1);
+    return this->distance (this->coord_, remote);
+}
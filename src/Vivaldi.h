@@ -0,0 +1,117 @@
+/*
+ * Vivaldi.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CS6381_CHORD_P2P_VIVALDI_H_
+#define CS6381_CHORD_P2P_VIVALDI_H_
+
+#include <map>
+#include <vector>
+using namespace std;
+
+#include <omnetpp.h>
+using namespace omnetpp;
+
+/**
+ * Vivaldi network coordinates (Dabek et al., SIGCOMM 2004): a position in a
+ * low-dimensional Euclidean space plus a height, placed so that the
+ * distance between two nodes predicts the RTT between them. The distance
+ * is that of the positions plus both heights; the heights stand for the
+ * access links every path of a node goes through.
+ *
+ * Every RTT sample to a peer whose coordinates and error come with it
+ * moves us along the line between us by
+ *
+ *   w = e / (e + e_peer)
+ *   x <- x + cc w (rtt - |x - x_peer|) u(x - x_peer)
+ *   e <- ce w |dist - rtt| / rtt + (1 - ce w) e
+ *
+ * so that a node that is sure of its place moves little towards one that
+ * is not. Samples and coordinates ride on the messages the nodes exchange
+ * anyway; there is no probing. The coordinates of the peers we heard of
+ * are kept, so that the RTT to a peer predicts before we ever talk to it.
+ *
+ * Positions are in seconds of RTT.
+ */
+class Vivaldi {
+public:
+    typedef vector<double> Coord;   // position, then height
+
+    Vivaldi (void);
+
+    // start out at the origin with the given number of dimensions, time step
+    // cc and error weight ce; the RNG breaks ties of nodes in one place
+    void init (int dimensions, double cc, double ce, cRNG *rng);
+
+    bool enabled (void) const { return !this->coord_.empty (); }
+
+    // our coordinates and how far off (relatively) we think they are
+    const Coord &coord (void) const { return this->coord_; }
+    double error (void) const { return this->error_; }
+
+    // a round-trip sample to a peer at the given coordinates: move, and
+    // remember where the peer is
+    void sample (int peer, simtime_t rtt, const Coord &remote, double remoteError);
+
+    // remember where a peer is without a sample to it
+    void learn (int peer, const Coord &remote, double remoteError);
+
+    // do we know where the peer is
+    bool knows (int peer) const;
+
+    // the RTT the coordinates predict to a peer; negative if we do not know
+    // where it is
+    simtime_t predict (int peer) const;
+    simtime_t predict (const Coord &remote) const;
+
+    // number of samples taken and of peers we know the place of
+    long num_samples (void) const { return this->numSamples_; }
+    int num_known (void) const { return this->peers_.size (); }
+
+    // mean relative error of the predictions against the samples taken
+    double mean_sample_error (void) const
+    {
+        return (this->numSamples_ > 0) ? this->sampleErrorSum_ / this->numSamples_ : 0.0;
+    }
+
+    // our coordinates into a message with coord[] and coordError fields, and
+    // those of the sender out of one (empty if it carries none)
+    template <class M> void stamp (M *msg) const
+    {
+        msg->setCoordArraySize (this->coord_.size ());
+        for (size_t i = 0; i < this->coord_.size (); ++i)
+            msg->setCoord (i, this->coord_[i]);
+        msg->setCoordError (this->error_);
+    }
+
+    template <class M> static Coord read (const M *msg)
+    {
+        Coord c (msg->getCoordArraySize ());
+        for (size_t i = 0; i < c.size (); ++i)
+            c[i] = msg->getCoord (i);
+        return c;
+    }
+
+private:
+    // distance between two points: of the positions, plus both heights
+    double distance (const Coord &a, const Coord &b) const;
+
+    struct Peer {
+        Coord coord;
+        double error;
+    };
+    typedef map<int, Peer> PeerMap;     // indexed by peer
+
+    Coord coord_;           // empty until init
+    double error_;
+    double cc_;
+    double ce_;
+    cRNG *rng_;
+    PeerMap peers_;
+    long numSamples_;
+    double sampleErrorSum_;
+};
+
+#endif /* CS6381_CHORD_P2P_VIVALDI_H_ */